@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief deterministic input line corpora for the benchmarks
+ *
+ * @details
+ * The same arguments always result in the same corpus (fixed seed). Therefore, the corpora do not have to be stored
+ * in the repository: use 'stdin-to-modbus-shm-bench --write-corpus NAME --lines N' to write a corpus to stdout.
+ */
+class Corpus {
+public:
+    //* number of registers per register type that the addresses of the corpora are limited to
+    static constexpr std::size_t REGISTERS = 4096;
+
+    //* all encodings of the data types (short identifiers, the aliases use the same parse functions)
+    static constexpr std::array<std::string_view, 32> DATA_TYPES = {
+            "f32b",  "f32l", "f32br", "f32lr", "f64b", "f64l", "f64br", "f64lr", "u16b",  "u16l",  "i16b",
+            "i16l",  "u32b", "u32l",  "u32br", "u32lr", "i32b", "i32l",  "i32br", "i32lr", "u64b",  "u64l",
+            "u64br", "u64lr", "i64b", "i64l",  "i64br", "i64lr", "u8_lo", "u8_hi", "i8_lo", "i8_hi"};
+
+    //* kinds of corpora
+    enum class kind_t {
+        UNTYPED,    // "ao:<addr>:<value>" (all register types)
+        TYPED,      // "ao:<addr>:<value>:<data type>"
+        CONSTANTS,  // "do:<addr>:true", "ao:<addr>:pi:f32b", ...
+        COMPAT,     // "f:ao:<addr>:<value>" (modbus_conv_float compatibility)
+        MIXED,      // mixture of all other kinds (all data types)
+    };
+
+private:
+    std::string                   text;  // all lines (separated by newlines)
+    std::vector<std::string_view> lines;
+
+public:
+    /**
+     * @brief generate corpus
+     * @param kind kind of corpus
+     * @param line_count number of lines
+     * @param data_type data type of the kind TYPED (element of DATA_TYPES)
+     */
+    Corpus(kind_t kind, std::size_t line_count, std::string_view data_type = {}) {
+        std::mt19937_64    random(line_count);  // NOLINT(cert-msc32-c,cert-msc51-cpp): deterministic on purpose
+        std::ostringstream o;
+        for (std::size_t i = 0; i < line_count; ++i) {
+            switch (kind) {
+                case kind_t::UNTYPED: untyped_line(o, random); break;
+                case kind_t::TYPED: typed_line(o, random, data_type); break;
+                case kind_t::CONSTANTS: constant_line(o, random); break;
+                case kind_t::COMPAT: compat_line(o, random); break;
+                case kind_t::MIXED:
+                    switch (random() % 4) {
+                        case 0: untyped_line(o, random); break;
+                        case 1: constant_line(o, random); break;
+                        case 2: compat_line(o, random); break;
+                        default: typed_line(o, random, DATA_TYPES[random() % DATA_TYPES.size()]); break;
+                    }
+                    break;
+            }
+            o << '\n';
+        }
+        text = o.str();
+
+        lines.reserve(line_count);
+        for (std::size_t start = 0; start < text.size();) {
+            const auto end = text.find('\n', start);
+            lines.emplace_back(text.data() + start, end - start);
+            start = end + 1;
+        }
+    }
+
+    //* all lines (separated by newlines, including the last line)
+    [[nodiscard]] const std::string &get_text() const { return text; }
+
+    //* lines (without newline)
+    [[nodiscard]] const std::vector<std::string_view> &get_lines() const { return lines; }
+
+private:
+    static constexpr std::array<std::string_view, 4> REGISTER_TYPES = {"do", "di", "ao", "ai"};
+
+    //* largest address that is valid for values of up to 4 registers
+    static constexpr std::size_t MAX_ADDRESS = REGISTERS - 4;
+
+    static void untyped_line(std::ostream &o, std::mt19937_64 &random) {
+        const auto type = random() % REGISTER_TYPES.size();
+        o << REGISTER_TYPES[type] << ':' << random() % MAX_ADDRESS << ':';
+        if (type < 2) o << random() % 2;
+        else
+            o << random() % 0x10000;
+    }
+
+    static void typed_line(std::ostream &o, std::mt19937_64 &random, std::string_view data_type) {
+        o << (random() % 2 ? "ao" : "ai") << ':' << random() % MAX_ADDRESS << ':';
+
+        const auto bits   = random();
+        const auto prefix = data_type.substr(0, 3);
+        if (prefix.starts_with('f')) {
+            std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+            o << distribution(random);
+        } else if (prefix == "u16") {
+            o << static_cast<uint16_t>(bits);
+        } else if (prefix == "i16") {
+            o << static_cast<int16_t>(bits);
+        } else if (prefix == "u32") {
+            o << static_cast<uint32_t>(bits);
+        } else if (prefix == "i32") {
+            o << static_cast<int32_t>(bits);
+        } else if (prefix == "u64") {
+            o << bits;
+        } else if (prefix == "i64") {
+            o << static_cast<int64_t>(bits);
+        } else if (prefix.starts_with("u8")) {
+            o << static_cast<unsigned>(static_cast<uint8_t>(bits));
+        } else {
+            o << static_cast<int>(static_cast<int8_t>(bits));
+        }
+
+        o << ':' << data_type;
+    }
+
+    static void constant_line(std::ostream &o, std::mt19937_64 &random) {
+        static constexpr std::array<std::string_view, 6> BOOL_CONSTANTS = {"true", "false", "on", "off", "high", "low"};
+        static constexpr std::array<std::string_view, 6> FLOAT_CONSTANTS = {"pi", "npi", "sqrt2", "phi", "ln2", "e"};
+
+        if (random() % 2) {
+            o << (random() % 2 ? "do" : "di") << ':' << random() % MAX_ADDRESS << ':'
+              << BOOL_CONSTANTS[random() % BOOL_CONSTANTS.size()];
+        } else {
+            o << "ao:" << random() % MAX_ADDRESS << ':' << FLOAT_CONSTANTS[random() % FLOAT_CONSTANTS.size()]
+              << (random() % 2 ? ":f32b" : ":f64l");
+        }
+    }
+
+    static void compat_line(std::ostream &o, std::mt19937_64 &random) {
+        std::uniform_real_distribution<double> distribution(-1000, 1000);
+        o << "f:ao:" << random() % MAX_ADDRESS << ':' << distribution(random);
+    }
+};
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#include "Corpus.hpp"
+#include "InputParser.hpp"
+#include "split_string.hpp"
+
+#include "cxxsemaphore.hpp"
+#include "cxxshm.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sysexits.h>
+#include <unistd.h>
+#include <vector>
+
+//* minimum number of measured runs per benchmark
+static constexpr std::size_t MIN_RUNS = 3;
+
+//* benchmark: processes all lines of a corpus
+struct benchmark_t {
+    std::string                         name;
+    std::function<Corpus()>             corpus;
+    std::function<void(const Corpus &)> run;
+};
+
+//* prevents that the compiler removes the benchmarked code
+static volatile uint64_t sink = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+/**
+ * @brief private shared memory (DO, DI, AO, AI) and semaphore for the end to end benchmarks
+ *
+ * @details
+ * The names contain the pid. The shared memory and the semaphore are removed on destruction.
+ */
+class BenchShm {
+private:
+    std::array<std::unique_ptr<cxxshm::SharedMemory>, 4> shm;
+    std::unique_ptr<cxxsemaphore::Semaphore>             semaphore;
+
+public:
+    BenchShm() {
+        static constexpr std::array<const char *, 4> SUFFIXES = {"DO", "DI", "AO", "AI"};
+
+        const std::string prefix = "stdin_to_modbus_shm_bench_" + std::to_string(getpid()) + '_';
+        for (std::size_t i = 0; i < shm.size(); ++i) {
+            const std::size_t element_size = i < 2 ? sizeof(uint8_t) : sizeof(uint16_t);
+            shm[i] = std::make_unique<cxxshm::SharedMemory>(prefix + SUFFIXES[i], Corpus::REGISTERS * element_size);
+        }
+        semaphore = std::make_unique<cxxsemaphore::Semaphore>(prefix + "sem", 1, true);
+    }
+
+    /**
+     * @brief parse a line and write the instructions to the shared memory (see write_register in main.cpp)
+     * @param line input line
+     * @param instructions instruction buffer
+     * @param use_semaphore acquire the semaphore while writing
+     */
+    void write(std::string_view line, InputParser::Instructions &instructions, bool use_semaphore) {
+        InputParser::parse(line, instructions);
+
+        if (use_semaphore) semaphore->wait();
+        for (const auto &instruction : instructions) {
+            switch (instruction.register_type) {
+                case InputParser::Instruction::register_type_t::DO:
+                    shm[0]->get_addr<uint8_t *>()[instruction.address] = static_cast<uint8_t>(instruction.value);
+                    break;
+                case InputParser::Instruction::register_type_t::DI:
+                    shm[1]->get_addr<uint8_t *>()[instruction.address] = static_cast<uint8_t>(instruction.value);
+                    break;
+                case InputParser::Instruction::register_type_t::AO:
+                    shm[2]->get_addr<uint16_t *>()[instruction.address] = instruction.value;
+                    break;
+                case InputParser::Instruction::register_type_t::AI:
+                    shm[3]->get_addr<uint16_t *>()[instruction.address] = instruction.value;
+                    break;
+            }
+        }
+        if (use_semaphore) semaphore->post();
+    }
+};
+
+/**
+ * @brief parse all lines of a corpus
+ * @param corpus corpus
+ */
+static void parse_corpus(const Corpus &corpus) {
+    InputParser::Instructions instructions;
+    uint64_t                  sum = 0;
+    for (const auto line : corpus.get_lines()) {
+        InputParser::parse(line, instructions);
+        for (const auto &instruction : instructions)
+            sum += instruction.value;
+    }
+    sink = sum;
+}
+
+/**
+ * @brief create the list of all benchmarks
+ * @param lines number of lines per corpus
+ * @param shm shared memory of the end to end benchmarks
+ * @return benchmarks
+ */
+static std::vector<benchmark_t> make_benchmarks(std::size_t lines, BenchShm &shm) {
+    std::vector<benchmark_t> benchmarks;
+
+    auto corpus = [lines](Corpus::kind_t kind, std::string_view data_type = {}) {
+        return [=]() { return Corpus(kind, lines, data_type); };
+    };
+
+    benchmarks.push_back({"parse/untyped", corpus(Corpus::kind_t::UNTYPED), parse_corpus});
+    for (const auto data_type : Corpus::DATA_TYPES)
+        benchmarks.push_back(
+                {"parse/typed/" + std::string(data_type), corpus(Corpus::kind_t::TYPED, data_type), parse_corpus});
+    benchmarks.push_back({"parse/constants", corpus(Corpus::kind_t::CONSTANTS), parse_corpus});
+    benchmarks.push_back({"parse/compat", corpus(Corpus::kind_t::COMPAT), parse_corpus});
+    benchmarks.push_back({"parse/mixed", corpus(Corpus::kind_t::MIXED), parse_corpus});
+
+    benchmarks.push_back({"split_string/untyped", corpus(Corpus::kind_t::UNTYPED), [](const Corpus &c) {
+                              uint64_t    sum = 0;
+                              std::string line;
+                              for (const auto l : c.get_lines()) {
+                                  line.assign(l);
+                                  sum += split_string(line, ':').size();
+                              }
+                              sink = sum;
+                          }});
+
+    for (const bool use_semaphore : {false, true}) {
+        benchmarks.push_back({use_semaphore ? "write/mixed/semaphore" : "write/mixed",
+                              corpus(Corpus::kind_t::MIXED),
+                              [&shm, use_semaphore](const Corpus &c) {
+                                  InputParser::Instructions instructions;
+                                  for (const auto line : c.get_lines())
+                                      shm.write(line, instructions, use_semaphore);
+                              }});
+    }
+
+    return benchmarks;
+}
+
+/**
+ * @brief write a corpus to stdout
+ * @param name name of the corpus (untyped, typed-<data type>, constants, compat, mixed)
+ * @param lines number of lines
+ * @return false if the name is unknown
+ */
+static bool write_corpus(std::string_view name, std::size_t lines) {
+    static constexpr std::string_view TYPED_PREFIX = "typed-";
+
+    std::unique_ptr<Corpus> corpus;
+    if (name == "untyped") corpus = std::make_unique<Corpus>(Corpus::kind_t::UNTYPED, lines);
+    else if (name == "constants") corpus = std::make_unique<Corpus>(Corpus::kind_t::CONSTANTS, lines);
+    else if (name == "compat") corpus = std::make_unique<Corpus>(Corpus::kind_t::COMPAT, lines);
+    else if (name == "mixed") corpus = std::make_unique<Corpus>(Corpus::kind_t::MIXED, lines);
+    else if (name.starts_with(TYPED_PREFIX)) {
+        const auto data_type = name.substr(TYPED_PREFIX.size());
+        if (std::find(Corpus::DATA_TYPES.begin(), Corpus::DATA_TYPES.end(), data_type) == Corpus::DATA_TYPES.end())
+            return false;
+        corpus = std::make_unique<Corpus>(Corpus::kind_t::TYPED, lines, data_type);
+    } else
+        return false;
+
+    std::cout << corpus->get_text() << std::flush;
+    return true;
+}
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("stdin-to-modbus-shm-bench", "Benchmarks of the parser and the write path");
+
+    // clang-format off
+    options.add_options()
+            ("f,filter", "run only benchmarks whose name contains the given string", cxxopts::value<std::string>())
+            ("n,lines", "number of lines per corpus", cxxopts::value<std::size_t>()->default_value("1000000"))
+            ("t,min-time", "minimum measured time per benchmark (in seconds)",
+             cxxopts::value<double>()->default_value("1"))
+            ("l,list", "list the names of all benchmarks")
+            ("write-corpus", "write a corpus (untyped, typed-<data type>, constants, compat, mixed) to stdout and exit",
+             cxxopts::value<std::string>())
+            ("h,help", "print usage");
+    // clang-format on
+
+    cxxopts::ParseResult args;
+    try {
+        args = options.parse(argc, argv);
+    } catch (cxxopts::exceptions::parsing::exception &e) {
+        std::cerr << "Failed to parse arguments: " << e.what() << '.' << '\n';
+        return EX_USAGE;
+    }
+
+    if (args.count("help")) {
+        std::cout << options.help() << '\n';
+        return EX_OK;
+    }
+
+    const auto lines    = args["lines"].as<std::size_t>();
+    const auto min_time = std::chrono::duration<double>(args["min-time"].as<double>());
+    if (!lines) {
+        std::cerr << "lines: invalid value" << '\n';
+        return EX_USAGE;
+    }
+
+    if (args.count("write-corpus")) {
+        if (!write_corpus(args["write-corpus"].as<std::string>(), lines)) {
+            std::cerr << "unknown corpus '" << args["write-corpus"].as<std::string>() << "'\n";
+            return EX_USAGE;
+        }
+        return EX_OK;
+    }
+
+    std::unique_ptr<BenchShm> shm;
+    try {
+        shm = std::make_unique<BenchShm>();
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to create shared memory: " << e.what() << '\n';
+        return EX_OSERR;
+    }
+
+    const auto benchmarks = make_benchmarks(lines, *shm);
+    const auto filter     = args.count("filter") ? args["filter"].as<std::string>() : std::string();
+
+    if (args.count("list")) {
+        for (const auto &benchmark : benchmarks)
+            if (benchmark.name.find(filter) != std::string::npos) std::cout << benchmark.name << '\n';
+        return EX_OK;
+    }
+
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(14) << "ns/line (min)"
+              << std::setw(14) << "ns/line (avg)" << std::setw(14) << "Mlines/s" << '\n';
+
+    for (const auto &benchmark : benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos) continue;
+
+        const auto corpus = benchmark.corpus();
+        try {
+            benchmark.run(corpus);  // warm up (caches, page faults)
+        } catch (const std::exception &e) {
+            std::cerr << benchmark.name << ": " << e.what() << '\n';
+            return EX_SOFTWARE;
+        }
+
+        std::chrono::duration<double> total {};
+        std::chrono::duration<double> best = std::chrono::duration<double>::max();
+        std::size_t                   runs = 0;
+        while (runs < MIN_RUNS || total < min_time) {
+            const auto start = std::chrono::steady_clock::now();
+            benchmark.run(corpus);
+            const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+            total += duration;
+            best = std::min(best, duration);
+            ++runs;
+        }
+
+        const auto count = static_cast<double>(corpus.get_lines().size());
+        const auto min   = best.count() * 1e9 / count;
+        const auto avg   = total.count() * 1e9 / (count * static_cast<double>(runs));
+        std::cout << std::left << std::setw(32) << benchmark.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << min << std::setw(14) << avg << std::setprecision(2) << std::setw(14)
+                  << 1e3 / min << '\n'
+                  << std::flush;
+    }
+}
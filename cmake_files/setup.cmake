@@ -132,6 +132,11 @@ if(ENABLE_TEST)
     add_subdirectory("test")
 endif()
 
+# add benchmark target
+if(BUILD_BENCHMARK)
+    add_subdirectory("bench")
+endif()
+
 # generate version_info.cpp
 # output is not the acutal generated file --> command is always executed
 add_custom_command(
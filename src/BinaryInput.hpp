@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief binary input protocol
+ *
+ * @details
+ * The binary input is a stream of records. Each record consists of a fixed size header followed by the payload.
+ * All fields are in host byte order.
+ *
+ * header (8 bytes):
+ *   - uint8_t  magic          (always MAGIC)
+ *   - uint8_t  register type  (0: DO, 1: DI, 2: AO, 3: AI)
+ *   - uint16_t start address
+ *   - uint16_t number of registers
+ *   - uint16_t reserved       (must be 0)
+ *
+ * payload:
+ *   - one uint16_t per register (raw register value, for DO and DI all values different from 0 are interpreted as 1)
+ */
+namespace BinaryInput {
+
+//* first byte of every record
+static constexpr uint8_t MAGIC = 0xA5;
+
+/**
+ * @brief record header
+ */
+struct RecordHeader {
+    uint8_t  magic         = MAGIC;  //*< record magic
+    uint8_t  register_type = 0;      //*< register type (see InputParser::Instruction::register_type_t)
+    uint16_t address       = 0;      //*< start address
+    uint16_t count         = 0;      //*< number of registers
+    uint16_t reserved      = 0;      //*< reserved (0)
+};
+
+static_assert(sizeof(RecordHeader) == 8, "unexpected record header size");
+
+//* size of the record header
+static constexpr std::size_t HEADER_SIZE = sizeof(RecordHeader);
+
+//* maximum size of a record
+static constexpr std::size_t MAX_RECORD_SIZE = HEADER_SIZE + UINT16_MAX * sizeof(uint16_t);
+
+/**
+ * @brief read and check record header
+ *
+ * @param data pointer to the first byte of the record (no alignment requirements)
+ * @return record header
+ *
+ * @exception std::invalid_argument thrown if the header is not valid
+ */
+static RecordHeader read_header(const char *data) {
+    RecordHeader header;
+    std::memcpy(&header, data, HEADER_SIZE);
+
+    if (header.magic != MAGIC) throw std::invalid_argument("invalid record magic");
+    if (header.register_type > static_cast<uint8_t>(InputParser::Instruction::register_type_t::AI))
+        throw std::invalid_argument("invalid register type");
+    if (header.reserved != 0) throw std::invalid_argument("reserved header field is not 0");
+
+    return header;
+}
+
+/**
+ * @brief get the size of the payload of a record
+ * @param header record header
+ * @return payload size in bytes
+ */
+static constexpr std::size_t payload_size(const RecordHeader &header) {
+    return static_cast<std::size_t>(header.count) * sizeof(uint16_t);
+}
+
+}  // namespace BinaryInput
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+#include "InputParser_float.hpp"
+#include "InputParser_tokenize.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief signal generator (input command 'gen', see documentation)
+ *
+ * @details
+ * Syntax: gen REGISTER_TYPE:ADDRESS[:DATA_TYPE] WAVEFORM [PARAMETER=VALUE ...]
+ *
+ * The values are computed for the sample times (multiples of 1/rate after the first sample) and encoded directly into
+ * the registers (see InputParser::encode_template). If several samples are due at once (e.g. the semaphore was not
+ * available), only the latest one is written.
+ */
+class Generator {
+public:
+    //* maximum number of samples per second
+    static constexpr double MAX_RATE = 1e6;
+
+    //* minimum number of samples per second (the sample interval in ns has to fit into 64 bit)
+    static constexpr double MIN_RATE = 1e-6;
+
+    enum class waveform_t { SINE, RAMP, COUNTER, RANDOM };
+
+private:
+    std::string                           definition;  // register type, address and data type
+    InputParser::Template                 target;
+    waveform_t                            waveform = waveform_t::SINE;
+    double                                amp      = 1.0;
+    double                                freq     = 1.0;
+    double                                offset   = 0.0;
+    double                                phase    = 0.0;  // rad
+    double                                min      = 0.0;
+    double                                max      = 100.0;
+    double                                period   = 1.0;
+    double                                start    = 0.0;
+    double                                step     = 1.0;
+    double                                rate     = 10.0;
+    uint64_t                              count    = 0;  // number of samples (0: unlimited)
+    uint64_t                              samples  = 0;  // next sample
+    uint64_t                              skipped  = 0;  // samples that were not written in time
+    std::mt19937_64                       rng;
+    std::chrono::nanoseconds              interval {};
+    std::chrono::steady_clock::time_point start_time;  // time of the first sample
+    bool                                  started = false;
+
+    /**
+     * @brief convert a parameter value to an unsigned integer
+     * @param parameter parameter name (error message)
+     * @param value parameter value
+     * @return value as integer
+     *
+     * @exception std::invalid_argument thrown if the value is no non-negative integer that fits into 64 bit
+     */
+    static uint64_t to_uint64(const char *parameter, double value) {
+        static constexpr double LIMIT = 18446744073709551616.0;  // 2^64
+        if (!(value >= 0.0 && value < LIMIT) || value - std::floor(value) > 0.0)
+            throw std::invalid_argument(std::string(parameter) + " has to be a non-negative integer");
+        return static_cast<uint64_t>(value);
+    }
+
+    //* value of sample n
+    double value(uint64_t n) {
+        const double t = static_cast<double>(n) / rate;
+        switch (waveform) {
+            case waveform_t::SINE: return offset + amp * std::sin(2.0 * std::numbers::pi * freq * t + phase);
+            case waveform_t::RAMP: {
+                const double cycles = t / period;
+                return min + (max - min) * (cycles - std::floor(cycles));
+            }
+            case waveform_t::COUNTER: {
+                const double range = max - min + 1.0;
+                double       pos   = std::fmod(start - min + static_cast<double>(n) * step, range);
+                if (pos < 0) pos += range;
+                return min + pos;
+            }
+            case waveform_t::RANDOM: return std::uniform_real_distribution<double>(min, max)(rng);
+        }
+        return 0.0;
+    }
+
+public:
+    /**
+     * @brief create generator
+     * @param command arguments of the command 'gen' (target, waveform and parameters)
+     * @param base_addr numerical base for converting the address
+     *
+     * @exception std::invalid_argument thrown if the command is not valid
+     */
+    Generator(std::string_view command, int base_addr) : rng(std::random_device()()) {
+        std::size_t field = 0;
+        bool        range = false;  // min or max specified
+        bool        first = false;  // start specified
+        InputParser::for_each_field(command, ' ', [&](std::string_view arg) {
+            if (arg.empty()) return true;
+
+            if (field == 0) {
+                definition = std::string(arg);
+            } else if (field == 1) {
+                if (arg == "sine") waveform = waveform_t::SINE;
+                else if (arg == "ramp")
+                    waveform = waveform_t::RAMP;
+                else if (arg == "counter") {
+                    waveform = waveform_t::COUNTER;
+                    max      = static_cast<double>(UINT16_MAX);
+                } else if (arg == "random")
+                    waveform = waveform_t::RANDOM;
+                else
+                    throw std::invalid_argument("unknown waveform '" + std::string(arg) + "'");
+            } else {
+                const auto equal = arg.find('=');
+                if (equal == std::string_view::npos) {
+                    throw std::invalid_argument("invalid parameter '" + std::string(arg) +
+                                                "' (expected NAME=VALUE)");
+                }
+                const auto name  = arg.substr(0, equal);
+                const auto value = InputParser::parse_double(arg.substr(equal + 1));
+
+                const bool sine    = waveform == waveform_t::SINE;
+                const bool counter = waveform == waveform_t::COUNTER;
+                if (name == "rate") rate = value;
+                else if (name == "count")
+                    count = to_uint64("count", value);
+                else if (sine && name == "amp")
+                    amp = value;
+                else if (sine && name == "freq")
+                    freq = value;
+                else if (sine && name == "offset")
+                    offset = value;
+                else if (sine && name == "phase")
+                    phase = value * std::numbers::pi / 180.0;
+                else if (!sine && name == "min") {
+                    min   = value;
+                    range = true;
+                } else if (!sine && name == "max") {
+                    max   = value;
+                    range = true;
+                } else if (waveform == waveform_t::RAMP && name == "period")
+                    period = value;
+                else if (counter && name == "start") {
+                    start = value;
+                    first = true;
+                } else if (counter && name == "step")
+                    step = value;
+                else if (waveform == waveform_t::RANDOM && name == "seed")
+                    rng.seed(to_uint64("seed", value));
+                else
+                    throw std::invalid_argument("unknown parameter '" + std::string(name) + "'");
+            }
+            ++field;
+            return true;
+        });
+
+        if (field < 2) throw std::invalid_argument("expected: gen REGISTER_TYPE:ADDRESS[:DATA_TYPE] WAVEFORM");
+
+        // the target is compiled as template with the value $1 (REGISTER_TYPE:ADDRESS:$1[:DATA_TYPE])
+        const auto address_end = definition.find(':', definition.find(':') + 1);
+        auto       tpl         = definition;
+        if (address_end == std::string::npos) tpl += ":$1";
+        else
+            tpl.insert(address_end, ":$1");
+        target = InputParser::compile_template(tpl, base_addr);
+
+        if (!(rate >= MIN_RATE) || rate > MAX_RATE)
+            throw std::invalid_argument("rate has to be in the range [1e-6, 1e6]");
+        if (!(period > 0.0)) throw std::invalid_argument("period has to be positive");
+        if (range && !(min <= max)) throw std::invalid_argument("min has to be less than or equal to max");
+        if (waveform == waveform_t::COUNTER && !first) start = min;
+
+        interval = std::chrono::nanoseconds(static_cast<int64_t>(std::llround(1e9 / rate)));
+    }
+
+    //* register type, address and data type (e.g. ao:100:f32_badc)
+    [[nodiscard]] const std::string &get_definition() const { return definition; }
+
+    //* register type of the target
+    [[nodiscard]] InputParser::Instruction::register_type_t get_register_type() const { return target.register_type; }
+
+    //* first register of the target
+    [[nodiscard]] std::size_t get_address() const { return target.address; }
+
+    //* number of registers of the target
+    [[nodiscard]] std::size_t get_registers() const { return target.registers; }
+
+    //* number of samples that were written
+    [[nodiscard]] uint64_t get_samples() const { return samples - skipped; }
+
+    //* number of samples that were skipped (not written in time)
+    [[nodiscard]] uint64_t get_skipped() const { return skipped; }
+
+    //* time of the next sample (the first sample is due immediately)
+    [[nodiscard]] std::chrono::steady_clock::time_point next_time() const {
+        if (!started) return std::chrono::steady_clock::time_point::min();
+        return start_time + interval * static_cast<int64_t>(samples);
+    }
+
+    //* true if all samples are generated (see parameter count)
+    [[nodiscard]] bool finished() const { return count && samples >= count; }
+
+    /**
+     * @brief create the instructions of the latest due sample
+     * @param now current time
+     * @param out list that receives the instructions
+     * @return false if no sample is due
+     */
+    bool sample(std::chrono::steady_clock::time_point now, InputParser::Instructions &out) {
+        if (finished() || now < next_time()) return false;
+
+        if (!started) {
+            start_time = now;
+            started    = true;
+        }
+
+        auto n = static_cast<uint64_t>((now - start_time) / interval);
+        if (count && n >= count) n = count - 1;
+        skipped += n - samples;
+
+        // the random generator is advanced only once per written sample
+        InputParser::encode_template(target, value(n), out);
+        samples = n + 1;
+        return true;
+    }
+};
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+/**
+ * @brief histogram with logarithmic (power of 2) buckets
+ *
+ * @details
+ * Bucket 0 contains the value 0, bucket n (n > 0) contains the values [2^(n-1), 2^n).
+ * Adding a value does not allocate memory and does not access the clock.
+ */
+class Histogram {
+public:
+    //* number of buckets (the last bucket contains all larger values)
+    static constexpr std::size_t BUCKETS = 32;
+
+private:
+    std::array<uint64_t, BUCKETS> buckets {};
+    uint64_t                      count = 0;
+    uint64_t                      sum   = 0;
+    uint64_t                      max   = 0;
+
+public:
+    /**
+     * @brief add value
+     * @param value value
+     */
+    void add(uint64_t value) {
+        const auto bucket = std::min<std::size_t>(std::bit_width(value), BUCKETS - 1);
+        ++buckets[bucket];
+        ++count;
+        sum += value;
+        max = std::max(max, value);
+    }
+
+    //* number of values
+    [[nodiscard]] uint64_t get_count() const { return count; }
+
+    //* sum of all values
+    [[nodiscard]] uint64_t get_sum() const { return sum; }
+
+    //* largest value
+    [[nodiscard]] uint64_t get_max() const { return max; }
+
+    //* number of values in the bucket
+    [[nodiscard]] uint64_t get_bucket(std::size_t bucket) const { return buckets[bucket]; }
+
+    //* exclusive upper bound of the values in the bucket
+    static uint64_t upper_bound(std::size_t bucket) { return uint64_t {1} << bucket; }
+
+    /**
+     * @brief print histogram (only buckets that contain values)
+     * @param o output stream
+     * @param name name of the histogram (including unit)
+     */
+    void print(std::ostream &o, std::string_view name) const {
+        o << name << ": " << count << " values, max " << max;
+        if (count) o << ", avg " << sum / count;
+        o << '\n';
+
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            if (!buckets[i]) continue;
+            o << "  [" << (i ? upper_bound(i - 1) : 0) << ", ";
+            if (i == BUCKETS - 1) o << "inf";
+            else
+                o << upper_bound(i);
+            o << "): " << buckets[i] << '\n';
+        }
+    }
+};
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "readline/history.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief command history of the interactive mode (see --history)
+ *
+ * @details
+ * Entries can be added by any thread. They are added to the readline history by the readline thread (sync) and
+ * appended to the history file by a background thread. Neither the readline thread nor the thread that adds an entry
+ * waits for the file.
+ *
+ * The history file is loaded by the background thread, too. Only the last entries (history size) are read.
+ * The loaded entries are inserted in front of the entries of the session as soon as they are available.
+ */
+class History {
+private:
+    //* size of the blocks in which the history file is read (from the end)
+    static constexpr std::size_t LOAD_BLOCK_SIZE = 64 * 1024;
+
+    std::string path;  // empty: no history file
+    std::size_t size;  // maximum number of entries
+
+    std::mutex               mutex;
+    std::condition_variable  cv;
+    std::vector<std::string> pending_memory;  // entries that are not yet part of the readline history
+    std::vector<std::string> pending_file;    // entries that are not yet written to the history file
+    std::vector<std::string> loaded;          // entries of the history file (until merged)
+    bool                     load_done = false;
+    bool                     merged    = false;
+    bool                     stop      = false;
+
+    std::ofstream file;
+    std::thread   writer;
+
+    /**
+     * @brief read the last entries of the history file
+     * @param path file path
+     * @param max_entries maximum number of entries
+     * @param truncated set to true if the file contains more entries
+     * @return entries (oldest first)
+     */
+    static std::vector<std::string> load_tail(const std::string &path, std::size_t max_entries, bool &truncated) {
+        truncated = false;
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in || !max_entries) return {};
+
+        auto        start = static_cast<std::size_t>(in.tellg());
+        std::string data;
+        std::size_t newlines = 0;
+        while (start > 0 && newlines <= max_entries) {
+            const auto  length = std::min(LOAD_BLOCK_SIZE, start);
+            std::string block(length, '\0');
+            start -= length;
+            in.seekg(static_cast<std::streamoff>(start));
+            if (!in.read(block.data(), static_cast<std::streamsize>(length))) return {};
+            newlines += static_cast<std::size_t>(std::count(block.begin(), block.end(), '\n'));
+            data.insert(0, block);
+        }
+
+        std::vector<std::string> entries;
+        std::size_t              pos = 0;
+        if (start > 0) pos = data.find('\n') + 1;  // first line is incomplete
+        while (pos < data.size()) {
+            auto newline = data.find('\n', pos);
+            if (newline == std::string::npos) newline = data.size();
+            if (newline > pos) entries.emplace_back(data, pos, newline - pos);
+            pos = newline + 1;
+        }
+
+        truncated = start > 0 || entries.size() > max_entries;
+        if (entries.size() > max_entries)
+            entries.erase(entries.begin(), entries.end() - static_cast<std::ptrdiff_t>(max_entries));
+        return entries;
+    }
+
+    //* rewrite the history file with its last entries (the file only grows while the program is running)
+    void compact() {
+        bool       truncated {};
+        const auto entries = load_tail(path, size, truncated);
+        if (!truncated) return;
+
+        const auto    tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::trunc);
+        for (const auto &entry : entries)
+            out << entry << '\n';
+        out.close();
+
+        if (out) std::rename(tmp_path.c_str(), path.c_str());
+        else
+            std::remove(tmp_path.c_str());
+    }
+
+    //* background thread: load the history file, then append new entries
+    void writer_func() {
+        bool truncated {};
+        auto entries = load_tail(path, size, truncated);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        loaded    = std::move(entries);
+        load_done = true;
+
+        std::vector<std::string> write;
+        while (true) {
+            cv.wait(lock, [&] { return stop || !pending_file.empty(); });
+            write.swap(pending_file);
+            const bool last = stop;
+            lock.unlock();
+
+            for (const auto &entry : write)
+                file << entry << '\n';
+            file.flush();
+            write.clear();
+
+            if (last) break;
+            lock.lock();
+        }
+
+        file.close();
+        compact();
+    }
+
+public:
+    /**
+     * @brief create history
+     * @param path path of the history file (empty: no history file)
+     * @param size maximum number of entries (0: unlimited, no entries are loaded from the history file)
+     *
+     * @exception std::system_error thrown if the history file can not be opened
+     */
+    History(std::string path, std::size_t size) : path(std::move(path)), size(size) {
+        if (size) stifle_history(static_cast<int>(std::min<std::size_t>(size, INT32_MAX)));
+
+        if (this->path.empty()) {
+            load_done = true;
+            return;
+        }
+
+        file.open(this->path, std::ios::app);
+        if (!file.is_open())
+            throw std::system_error(errno, std::generic_category(), "failed to open '" + this->path + '\'');
+
+        writer = std::thread(&History::writer_func, this);
+    }
+
+    History(const History &)            = delete;
+    History(History &&)                 = delete;
+    History &operator=(const History &) = delete;
+    History &operator=(History &&)      = delete;
+
+    //* write the remaining entries to the history file
+    ~History() {
+        if (!writer.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stop = true;
+        }
+        cv.notify_one();
+        writer.join();
+    }
+
+    /**
+     * @brief add an entry (any thread, does not block)
+     * @param line entry
+     */
+    void add(std::string line) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!path.empty()) pending_file.push_back(line);
+            pending_memory.push_back(std::move(line));
+        }
+        if (!path.empty()) cv.notify_one();
+    }
+
+    /**
+     * @brief add the new entries to the readline history (readline thread only)
+     *
+     * @details
+     * Call before readline() is called.
+     */
+    void sync() {
+        std::vector<std::string> entries;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            entries.swap(pending_memory);
+
+            if (load_done && !merged) {
+                merged = true;
+                if (!loaded.empty()) {
+                    // the loaded entries are older than the entries of the session
+                    std::vector<std::string> session;
+                    for (int i = 0; i < history_length; ++i) {
+                        const auto *entry = history_get(history_base + i);
+                        if (entry) session.emplace_back(entry->line);
+                    }
+                    clear_history();
+                    for (const auto &entry : loaded)
+                        add_history(entry.c_str());
+                    for (const auto &entry : session)
+                        add_history(entry.c_str());
+                    loaded = {};
+                }
+            }
+        }
+
+        for (const auto &entry : entries)
+            add_history(entry.c_str());
+    }
+};
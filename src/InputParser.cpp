@@ -5,19 +5,26 @@
 
 #include "InputParser.hpp"
 
-#include "InputParser_float.hpp"
+#include "InputParser_codec.hpp"
 #include "InputParser_int.hpp"
-#include "split_string.hpp"
+#include "InputParser_string.hpp"
+#include "InputParser_tokenize.hpp"
+#include "StringMap.hpp"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
-#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace InputParser {
 
-typedef std::vector<Instruction> (*parse_function)(
-        Instruction::register_type_t, std::size_t, const std::string &, int, bool);
-
 /* Supported data types:
  *  - Float:
  *      - 32 Bit:
@@ -27,9 +34,9 @@ typedef std::vector<Instruction> (*parse_function)(
  *          - f32_badc, f32_little_rev, f32lr               32-Bit floating point in little endian, registers reversed
  *      - 64 Bit:
  *          - f64_abcdefgh, f64_big, f64b                   64-Bit floating point in big endian
- *          - f64_ghefcdab, f64_little, f64l                64-Bit floating point in little endian
- *          - f64_badcfehg, f64_big_rev, f64br              64-Bit floating point in big endian, registers reversed
- *          - f64_hgfedcba, f64_little_rev, f64lr           64-Bit floating point in little endian, registers reversed
+ *          - f64_hgfedcba, f64_little, f64l                64-Bit floating point in little endian
+ *          - f64_ghefcdab, f64_big_rev, f64br              64-Bit floating point in big endian, registers reversed
+ *          - f64_badcfehg, f64_little_rev, f64lr           64-Bit floating point in little endian, registers reversed
  *  - Int:
  *      - 8 Bit:
  *          - u8_lo                                         8-Bit unsigned integer written to low byte of register
@@ -61,194 +68,401 @@ typedef std::vector<Instruction> (*parse_function)(
  *          - i64_badcfehg, i64_little_rev, i64lr           64-Bit signed integer in little endian, registers reversed
  *
  */
-static const std::unordered_map<std::string, parse_function> PARSE_FUNCTIONS = {
-        // float
-        {"f32_abcd", parse_f32abcd},
-        {"f32_cdab", parse_f32cdab},
-        {"f32_badc", parse_f32badc},
-        {"f32_dcba", parse_f32dcba},
-        {"f32_little", parse_f32dcba},
-        {"f32l", parse_f32dcba},
-        {"f32_big", parse_f32abcd},
-        {"f32b", parse_f32abcd},
-        {"f32_little_rev", parse_f32badc},
-        {"f32lr", parse_f32badc},
-        {"f32_big_rev", parse_f32cdab},
-        {"f32br", parse_f32cdab},
-
-        // double
-        {"f64_abcdefgh", parse_f64abcdefgh},
-        {"f64_ghefcdab", parse_f64ghefcdab},
-        {"f64_badcfehg", parse_f64badcfehg},
-        {"f64_hgfedcba", parse_f64hgfedcba},
-        {"f64_little", parse_f64hgfedcba},
-        {"f64l", parse_f64hgfedcba},
-        {"f64_big", parse_f64abcdefgh},
-        {"f64b", parse_f64abcdefgh},
-        {"f64_little_rev", parse_f64badcfehg},
-        {"f64lr", parse_f64badcfehg},
-        {"f64_big_rev", parse_f64ghefcdab},
-        {"f64br", parse_f64ghefcdab},
-
-        // 8 bit integer
-        {"u8_lo", parse_u8_lo},
-        {"u8_hi", parse_u8_hi},
-        {"i8_lo", parse_i8_lo},
-        {"i8_hi", parse_i8_hi},
-
-        // 16 bit integer
-        {"u16_ab", parse_u16_ab},
-        {"u16_big", parse_u16_ab},
-        {"u16b", parse_u16_ab},
-        {"u16_ba", parse_u16_ba},
-        {"u16_little", parse_u16_ba},
-        {"u16l", parse_u16_ba},
-        {"i16_ab", parse_i16_ab},
-        {"i16_big", parse_i16_ab},
-        {"i16b", parse_i16_ab},
-        {"i16_ba", parse_i16_ba},
-        {"i16_little", parse_i16_ba},
-        {"i16l", parse_i16_ba},
-
-        // 32 bit integer
-        {"u32_abcd", parse_u32abcd},
-        {"u32_cdab", parse_u32cdab},
-        {"u32_badc", parse_u32badc},
-        {"u32_dcba", parse_u32dcba},
-        {"u32_little", parse_u32dcba},
-        {"u32l", parse_u32dcba},
-        {"u32_big", parse_u32abcd},
-        {"u32b", parse_u32abcd},
-        {"u32_little_rev", parse_u32badc},
-        {"u32lr", parse_u32badc},
-        {"u32_big_rev", parse_u32cdab},
-        {"u32br", parse_u32cdab},
-        {"i32_abcd", parse_i32abcd},
-        {"i32_cdab", parse_i32cdab},
-        {"i32_badc", parse_i32badc},
-        {"i32_dcba", parse_i32dcba},
-        {"i32_little", parse_i32dcba},
-        {"i32l", parse_i32dcba},
-        {"i32_big", parse_i32abcd},
-        {"i32b", parse_i32abcd},
-        {"i32_little_rev", parse_i32badc},
-        {"i32lr", parse_i32badc},
-        {"i32_big_rev", parse_i32cdab},
-        {"i32br", parse_i32cdab},
-
-        // 64 bit integer
-        {"u64_abcdefgh", parse_u64abcdefgh},
-        {"u64_ghefcdab", parse_u64ghefcdab},
-        {"u64_badcfehg", parse_u64badcfehg},
-        {"u64_hgfedcba", parse_u64hgfedcba},
-        {"u64_little", parse_u64hgfedcba},
-        {"u64l", parse_u64hgfedcba},
-        {"u64_big", parse_u64abcdefgh},
-        {"u64b", parse_u64abcdefgh},
-        {"u64_little_rev", parse_u64badcfehg},
-        {"u64lr", parse_u64badcfehg},
-        {"u64_big_rev", parse_u64ghefcdab},
-        {"u64br", parse_u64ghefcdab},
-        {"i64_abcdefgh", parse_i64abcdefgh},
-        {"i64_ghefcdab", parse_i64ghefcdab},
-        {"i64_badcfehg", parse_i64badcfehg},
-        {"i64_hgfedcba", parse_i64hgfedcba},
-        {"i64_little", parse_i64hgfedcba},
-        {"i64l", parse_i64hgfedcba},
-        {"i64_big", parse_i64abcdefgh},
-        {"i64b", parse_i64abcdefgh},
-        {"i64_little_rev", parse_i64badcfehg},
-        {"i64lr", parse_i64badcfehg},
-        {"i64_big_rev", parse_i64ghefcdab},
-        {"i64br", parse_i64ghefcdab},
+//* list of types
+template <typename... T>
+struct type_list {};
+
+//* data types that are encoded in one or more complete registers
+using REGISTER_DATA_TYPES = type_list<float, double, uint16_t, int16_t, uint32_t, int32_t, uint64_t, int64_t>;
+
+//* data types that are encoded in a single byte of a register
+using BYTE_DATA_TYPES = type_list<uint8_t, int8_t>;
+
+//* maximum length of a data type identifier
+static constexpr std::size_t MAX_DATA_TYPE_LENGTH = 16;
+
+//* data type identifier (constexpr string)
+struct data_type_name_t {
+    std::array<char, MAX_DATA_TYPE_LENGTH> str {};
+    std::size_t                            length = 0;
+
+    constexpr data_type_name_t &operator<<(std::string_view s) {
+        for (const char c : s)
+            str.at(length++) = c;
+        return *this;
+    }
+
+    constexpr data_type_name_t &operator<<(char c) {
+        str.at(length++) = c;
+        return *this;
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const { return {str.data(), length}; }
+};
+
+//* data type identifier and associated parse and encode functions
+struct data_type_t {
+    data_type_name_t name;
+    parse_function   function = nullptr;
+    encode_function  encode   = nullptr;
 };
 
-std::vector<Instruction> parse(std::string line, int base_addr, int base_value, bool verbose) {
-    static constexpr std::size_t MIN_ELEMENTS = 3;
-    static constexpr std::size_t MAX_ELEMENTS = 4;
-    static constexpr char        DELIMITER    = ':';
+/**
+ * @brief get the identifier prefix of a data type (e.g. f32, u16, i8)
+ * @tparam T data type
+ * @return prefix
+ */
+template <typename T>
+static constexpr data_type_name_t data_type_prefix() {
+    constexpr std::size_t BITS = sizeof(T) * 8;
 
-    // to lower input string
-    std::transform(line.begin(), line.end(), line.begin(), [](char c) { return std::tolower(c); });
+    data_type_name_t prefix;
+    if constexpr (std::is_floating_point_v<T>) prefix << 'f';
+    else if constexpr (std::is_signed_v<T>) prefix << 'i';
+    else
+        prefix << 'u';
 
-    // compatibility to modbus_conv_float (refactor lines that start with f:)
-    if (line.size() >= 2 && line[0] == 'f' && line[1] == ':') { line = line.substr(2) + ':' + "f32_badc"; }
+    if constexpr (BITS >= 10) prefix << static_cast<char>('0' + BITS / 10);
+    prefix << static_cast<char>('0' + BITS % 10);
+    return prefix;
+}
 
-    // split string
-    auto split_input = split_string(line, DELIMITER);
+//* number of identifiers per encoding (e.g. f32_abcd, f32_big, f32b)
+static constexpr std::size_t NAMES_PER_ENCODING = 3;
 
-    // check number of elements
-    if (split_input.size() > MAX_ELEMENTS || split_input.size() < MIN_ELEMENTS) {
-        throw std::invalid_argument("The input does not contain the appropriate number of delimiters");
+/**
+ * @brief number of supported register encodings (byte and word orders) of a data type
+ * @tparam T data type
+ * @return number of encodings
+ */
+template <typename T>
+static constexpr std::size_t encodings() {
+    // word order is only relevant for values with more than one register
+    return sizeof(T) == sizeof(uint16_t) ? 2 : 4;
+}
+
+/**
+ * @brief add the identifiers of one encoding of a data type
+ *
+ * @details
+ * Three identifiers are generated for each encoding:
+ *  - byte pattern: bytes of the value in the shared memory (a = most significant byte), e.g. f32_cdab
+ *  - long name:    e.g. f32_big_rev
+ *  - short name:   e.g. f32br
+ *
+ * @param data_types target list
+ * @param count number of elements in the target list
+ */
+template <typename T, ByteOrder ENDIAN, WordOrder REGISTER_ORDER, std::size_t N>
+static constexpr void add_data_type(std::array<data_type_t, N> &data_types, std::size_t &count) {
+    constexpr parse_function  FUNCTION = parse_value<codec<T, ENDIAN, REGISTER_ORDER>>;
+    constexpr encode_function ENCODE   = encode_value<codec<T, ENDIAN, REGISTER_ORDER>>;
+    constexpr bool            BIG      = ENDIAN == ByteOrder::BIG;
+    constexpr bool            REVERSED = REGISTER_ORDER == WordOrder::REVERSED;
+
+    // byte pattern
+    std::array<char, sizeof(T)> pattern {};
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        pattern[i] = static_cast<char>('a' + (BIG ? i : sizeof(T) - 1 - i));
+    if constexpr (REVERSED) {
+        for (std::size_t i = 0; i < sizeof(T) / 2; i += 2) {
+            std::swap(pattern[i], pattern[sizeof(T) - 2 - i]);
+            std::swap(pattern[i + 1], pattern[sizeof(T) - 1 - i]);
+        }
     }
 
-    // convert value expressions
-    if (split_input[2] == "true" || split_input[2] == "one" || split_input[2] == "high" || split_input[2] == "active" ||
-        split_input[2] == "on" || split_input[2] == "enabled") {
-        split_input[2] = "1";
-    } else if (split_input[2] == "false" || split_input[2] == "zero" || split_input[2] == "low" ||
-               split_input[2] == "inactive" || split_input[2] == "off" || split_input[2] == "disabled") {
-        split_input[2] = "0";
-    } else if (split_input[2] == "pi") {
-        split_input[2] = PI;
-    } else if (split_input[2] == "npi" || split_input[2] == "-pi") {
-        split_input[2] = NPI;
-    } else if (split_input[2] == "sqrt2") {
-        split_input[2] = SQRT2;
-    } else if (split_input[2] == "sqrt3") {
-        split_input[2] = SQRT3;
-    } else if (split_input[2] == "phi") {
-        split_input[2] = PHI;
-    } else if (split_input[2] == "ln2") {
-        split_input[2] = LN2;
-    } else if (split_input[2] == "e") {
-        split_input[2] = E;
+    data_types.at(count++) = {data_type_prefix<T>() << '_' << std::string_view(pattern.data(), pattern.size()),
+                              FUNCTION,
+                              ENCODE};
+    data_types.at(count++) = {data_type_prefix<T>() << (BIG ? "_big" : "_little") << (REVERSED ? "_rev" : ""),
+                              FUNCTION,
+                              ENCODE};
+    data_types.at(count++) = {data_type_prefix<T>() << (BIG ? "b" : "l") << (REVERSED ? "r" : ""), FUNCTION, ENCODE};
+}
+
+/**
+ * @brief add the identifiers of all encodings of a data type
+ * @param data_types target list
+ * @param count number of elements in the target list
+ */
+template <typename T, std::size_t N>
+static constexpr void add_register_data_type(std::array<data_type_t, N> &data_types, std::size_t &count) {
+    add_data_type<T, ByteOrder::BIG, WordOrder::NORMAL>(data_types, count);
+    add_data_type<T, ByteOrder::LITTLE, WordOrder::NORMAL>(data_types, count);
+    if constexpr (encodings<T>() > 2) {
+        add_data_type<T, ByteOrder::BIG, WordOrder::REVERSED>(data_types, count);
+        add_data_type<T, ByteOrder::LITTLE, WordOrder::REVERSED>(data_types, count);
     }
+}
 
-    // get register type
-    Instruction::register_type_t type {};
-    auto                        &type_str = split_input.at(0);
-    for (auto &c : type_str)
-        c = static_cast<char>(std::tolower(c));
-    if (type_str == "do") {
-        type = Instruction::register_type_t::DO;
-    } else if (type_str == "di") {
-        type = Instruction::register_type_t::DI;
-    } else if (type_str == "ao") {
-        type = Instruction::register_type_t::AO;
-    } else if (type_str == "ai") {
-        type = Instruction::register_type_t::AI;
-    } else {
-        throw std::invalid_argument('\'' + type_str + "' is not a valid register type");
+/**
+ * @brief add the identifiers of a single byte data type (e.g. u8_lo, u8_hi)
+ * @param data_types target list
+ * @param count number of elements in the target list
+ */
+template <typename T, std::size_t N>
+static constexpr void add_byte_data_type(std::array<data_type_t, N> &data_types, std::size_t &count) {
+    using low_t  = byte_codec<T, BytePosition::LOW>;
+    using high_t = byte_codec<T, BytePosition::HIGH>;
+    data_types.at(count++) = {data_type_prefix<T>() << "_lo", parse_value<low_t>, encode_value<low_t>};
+    data_types.at(count++) = {data_type_prefix<T>() << "_hi", parse_value<high_t>, encode_value<high_t>};
+}
+
+/**
+ * @brief generate the identifiers of all supported data types
+ * @return list of data type identifiers and the associated parse functions
+ */
+template <typename... REGISTER_TYPES, typename... BYTE_TYPES>
+static constexpr auto generate_data_types(type_list<REGISTER_TYPES...>, type_list<BYTE_TYPES...>) {
+    constexpr std::size_t N =
+            ((encodings<REGISTER_TYPES>() * NAMES_PER_ENCODING) + ... + 0) + sizeof...(BYTE_TYPES) * 2;
+
+    std::array<data_type_t, N> data_types {};
+    std::size_t                count = 0;
+    (add_register_data_type<REGISTER_TYPES>(data_types, count), ...);
+    (add_byte_data_type<BYTE_TYPES>(data_types, count), ...);
+    return data_types;
+}
+
+//* all supported data types
+static constexpr auto DATA_TYPES = generate_data_types(REGISTER_DATA_TYPES {}, BYTE_DATA_TYPES {});
+
+/**
+ * @brief create lookup table for the data type identifiers
+ * @return lookup table (identifier --> parse function)
+ */
+template <std::size_t N>
+static constexpr auto make_parse_functions(const std::array<data_type_t, N> &data_types) {
+    std::array<std::pair<std::string_view, parse_function>, N> entries {};
+    for (std::size_t i = 0; i < N; ++i)
+        entries[i] = {data_types[i].name.view(), data_types[i].function};
+    return StringMap<parse_function, N>(entries);
+}
+
+static constexpr auto PARSE_FUNCTIONS = make_parse_functions(DATA_TYPES);
+
+/**
+ * @brief create lookup table for the encode functions of the data type identifiers
+ * @return lookup table (identifier --> encode function)
+ */
+template <std::size_t N>
+static constexpr auto make_encode_functions(const std::array<data_type_t, N> &data_types) {
+    std::array<std::pair<std::string_view, encode_function>, N> entries {};
+    for (std::size_t i = 0; i < N; ++i)
+        entries[i] = {data_types[i].name.view(), data_types[i].encode};
+    return StringMap<encode_function, N>(entries);
+}
+
+static constexpr auto ENCODE_FUNCTIONS = make_encode_functions(DATA_TYPES);
+
+// check that all data type identifiers (see --data-types) are known and the aliases are consistent
+static_assert(PARSE_FUNCTIONS.size() == 88);
+static_assert(*PARSE_FUNCTIONS.find("f32_big") == *PARSE_FUNCTIONS.find("f32_abcd"));
+static_assert(*PARSE_FUNCTIONS.find("f32_little_rev") == *PARSE_FUNCTIONS.find("f32_badc"));
+static_assert(*PARSE_FUNCTIONS.find("f64_big_rev") == *PARSE_FUNCTIONS.find("f64_ghefcdab"));
+static_assert(*PARSE_FUNCTIONS.find("f64l") == *PARSE_FUNCTIONS.find("f64_hgfedcba"));
+static_assert(*PARSE_FUNCTIONS.find("u16l") == *PARSE_FUNCTIONS.find("u16_ba"));
+static_assert(*PARSE_FUNCTIONS.find("i32br") == *PARSE_FUNCTIONS.find("i32_cdab"));
+static_assert(*PARSE_FUNCTIONS.find("U64_LITTLE") == *PARSE_FUNCTIONS.find("u64_hgfedcba"));
+static_assert(*PARSE_FUNCTIONS.find("i64lr") == *PARSE_FUNCTIONS.find("i64_badcfehg"));
+static_assert(PARSE_FUNCTIONS.contains("u8_lo") && PARSE_FUNCTIONS.contains("i8_hi"));
+static_assert(!PARSE_FUNCTIONS.contains("f32") && !PARSE_FUNCTIONS.contains("u16"));
+
+//* register type identifiers
+static constexpr auto REGISTER_TYPES = make_string_map<Instruction::register_type_t>({
+        {"do", Instruction::register_type_t::DO},
+        {"di", Instruction::register_type_t::DI},
+        {"ao", Instruction::register_type_t::AO},
+        {"ai", Instruction::register_type_t::AI},
+});
+
+static_assert(*REGISTER_TYPES.find("AO") == Instruction::register_type_t::AO);
+static_assert(!REGISTER_TYPES.contains("a"));
+
+//* string constants that can be used as value (see --constants)
+static constexpr auto VALUE_CONSTANTS = make_string_map<std::string_view>({
+        // boolean true
+        {"true", "1"},
+        {"one", "1"},
+        {"high", "1"},
+        {"active", "1"},
+        {"on", "1"},
+        {"enabled", "1"},
+
+        // boolean false
+        {"false", "0"},
+        {"zero", "0"},
+        {"low", "0"},
+        {"inactive", "0"},
+        {"off", "0"},
+        {"disabled", "0"},
+
+        // mathematical constants
+        {"pi", PI},
+        {"npi", NPI},
+        {"-pi", NPI},
+        {"sqrt2", SQRT2},
+        {"sqrt3", SQRT3},
+        {"phi", PHI},
+        {"ln2", LN2},
+        {"e", E},
+});
+
+static_assert(*VALUE_CONSTANTS.find("On") == "1");
+static_assert(*VALUE_CONSTANTS.find("-pi") == NPI);
+
+/**
+ * @brief remove leading and trailing whitespace
+ * @param str string
+ * @return string without leading and trailing whitespace
+ */
+static std::string_view trim(std::string_view str) {
+    while (!str.empty() && is_space(str.front()))
+        str.remove_prefix(1);
+    while (!str.empty() && is_space(str.back()))
+        str.remove_suffix(1);
+    return str;
+}
+
+/**
+ * @brief convert hex data to register values
+ *
+ * @details
+ * The bytes are stored in the order of the input (memory byte order).
+ * For coils, every byte is the value of one coil. Otherwise, two bytes form one register.
+ *
+ * @param hex hex data (optional prefix 0x)
+ * @param coils true: one byte per register, false: two bytes per register
+ * @param pattern vector that receives the register values
+ *
+ * @exception std::invalid_argument thrown if the data is not valid
+ */
+static void parse_hex_data(std::string_view hex, bool coils, std::pmr::vector<uint16_t> &pattern) {
+    if (hex.size() >= 2 && hex[0] == '0' && to_lower(hex[1]) == 'x') hex.remove_prefix(2);
+
+    const std::size_t bytes_per_register = coils ? 1 : 2;
+    const std::size_t chars_per_register = bytes_per_register * 2;
+
+    if (hex.empty() || hex.size() % chars_per_register != 0) {
+        throw std::invalid_argument("Invalid hex data length (must be a multiple of " +
+                                    std::to_string(bytes_per_register) + " bytes)");
     }
 
-    // get address
-    std::size_t addr;
-    const auto &addr_str = split_input.at(1);
-    bool        fail     = false;
-    std::size_t idx      = 0;
-    try {
-        addr = std::stoull(addr_str, &idx, base_addr);
-    } catch (const std::exception &) { fail = true; }
-    fail = fail || idx != addr_str.size();
+    pattern.reserve(hex.size() / chars_per_register);
+    for (std::size_t i = 0; i < hex.size(); i += chars_per_register) {
+        std::array<uint8_t, 2> bytes {};
+        for (std::size_t k = 0; k < bytes_per_register; ++k) {
+            const auto *first  = hex.data() + i + k * 2;
+            const auto *last   = first + 2;
+            const auto  result = std::from_chars(first, last, bytes[k], 16);
+            if (result.ec != std::errc() || result.ptr != last) {
+                throw std::invalid_argument("Invalid hex data '" + std::string(hex) + '\'');
+            }
+        }
+
+        uint16_t value = bytes[0];
+        if (!coils) std::memcpy(&value, bytes.data(), sizeof(value));
+        pattern.push_back(value);
+    }
+}
+
+/**
+ * @brief convert a single value (constant, value with data type or untyped value)
+ * @param type register type
+ * @param address register address
+ * @param value_str value
+ * @param function parse function of the data type (nullptr: untyped value)
+ * @param base_value numerical base for converting values
+ * @param verbose verbose output of the parse function
+ * @return instructions
+ *
+ * @exception std::invalid_argument thrown if the value is not valid
+ */
+static Instructions convert_value(Instruction::register_type_t type,
+                                  std::size_t                  address,
+                                  std::string_view             value_str,
+                                  parse_function               function,
+                                  int                          base_value,
+                                  bool                         verbose) {
+    // convert value expressions
+    if (const auto *constant = VALUE_CONSTANTS.find(value_str)) value_str = *constant;
 
-    if (fail) throw std::invalid_argument("Failed to parse address '" + addr_str + '\'');
+    if (function) return function(type, address, value_str, base_value, verbose);
 
-    const auto &value_str = split_input.at(2);
+    // input does not specify a data type --> write single register
+    unsigned long long value {};
+    if (!parse_ull(value_str, base_value, value)) {
+        throw std::invalid_argument("Failed to parse value '" + std::string(value_str) + '\'');
+    }
+
+    return {Instruction(type, address, static_cast<uint16_t>(value))};
+}
 
-    if (split_input.size() == MIN_ELEMENTS) {  // input does not specify a data type --> write single register
-        // get value
-        std::size_t value;
-        try {
-            value = std::stoull(value_str, &idx, base_value);
-        } catch (const std::exception &) { fail = true; }
-        fail = fail || idx != value_str.size();
+void parse(std::string_view line, Instructions &out, int base_addr, int base_value, bool verbose) {
+    static constexpr std::size_t      MIN_ELEMENTS     = 3;
+    static constexpr std::size_t      MAX_ELEMENTS     = 4;
+    static constexpr char             DELIMITER        = ':';
+    static constexpr std::string_view COMPAT_DATA_TYPE = "f32_badc";
+    static constexpr std::string_view RANGE_DELIMITER  = "..";
+    static constexpr char             LIST_DELIMITER   = ',';
+    static constexpr std::string_view HEX_IDENTIFIER   = "hex";
+    static constexpr const char      *DELIMITER_ERROR =
+            "The input does not contain the appropriate number of delimiters";
 
-        if (fail) throw std::invalid_argument("Failed to parse value '" + value_str + '\'');
+    out.clear();
 
-        return {Instruction(type, addr, static_cast<uint16_t>(value))};
+    // compatibility to modbus_conv_float (lines that start with f: are f32_badc values)
+    const bool compat_float = line.size() >= 2 && to_lower(line[0]) == 'f' && line[1] == DELIMITER;
+    if (compat_float) line.remove_prefix(2);
 
-    } else {
+    // split string (a trailing delimiter is ignored)
+    std::array<std::string_view, MAX_ELEMENTS + 1> split_input {};
+    std::size_t                                    elements = 0;
+
+    const bool complete = for_each_field(line, DELIMITER, [&](std::string_view field) {
+        if (elements == split_input.size()) return false;
+        split_input[elements++] = field;
+        return true;
+    });
+    if (!complete) throw std::invalid_argument(DELIMITER_ERROR);
+    if (split_input[elements - 1].empty()) --elements;
+
+    // check number of elements
+    if (elements > (compat_float ? MIN_ELEMENTS : MAX_ELEMENTS) || elements < MIN_ELEMENTS) {
+        throw std::invalid_argument(DELIMITER_ERROR);
+    }
+
+    // get register type
+    const auto &type_str = split_input[0];
+    const auto *type_ptr = REGISTER_TYPES.find(type_str);
+    if (!type_ptr) throw unknown_type_error('\'' + std::string(type_str) + "' is not a valid register type");
+    const auto type = *type_ptr;
+
+    // get address (single address or range)
+    const auto &addr_str  = split_input[1];
+    const auto  range_pos = addr_str.find(RANGE_DELIMITER);
+    const bool  is_range  = range_pos != std::string_view::npos;
+
+    unsigned long long addr {};
+    unsigned long long addr_end {};
+    if (!parse_ull(addr_str.substr(0, range_pos), base_addr, addr) ||
+        (is_range && !parse_ull(addr_str.substr(range_pos + RANGE_DELIMITER.size()), base_addr, addr_end))) {
+        throw std::invalid_argument("Failed to parse address '" + std::string(addr_str) + '\'');
+    }
+    if (is_range && addr_end < addr) {
+        throw std::invalid_argument("Invalid address range '" + std::string(addr_str) + '\'');
+    }
+
+    // value: single value, list of values or raw hex data
+    const auto &value_str = split_input[2];
+    const bool  is_list   = value_str.size() >= 2 && value_str.front() == '[' && value_str.back() == ']';
+    const bool  is_hex    = iequals(value_str, HEX_IDENTIFIER);
+
+    if (is_hex && (compat_float || elements != MAX_ELEMENTS)) throw std::invalid_argument("Missing hex data");
+
+    // get data type
+    const parse_function *parse_function_ptr = nullptr;
+    if (!is_hex && (elements == MAX_ELEMENTS || compat_float)) {
         // check register type
         switch (type) {
             case Instruction::register_type_t::DO:
@@ -260,11 +474,158 @@ std::vector<Instruction> parse(std::string line, int base_addr, int base_value,
                 break;
         }
 
-        if (PARSE_FUNCTIONS.find(split_input.at(3)) == PARSE_FUNCTIONS.end()) {
-            throw std::invalid_argument("Unknown data type '" + split_input[3] + '\'');
+        const auto data_type_str = compat_float ? COMPAT_DATA_TYPE : split_input[3];
+        parse_function_ptr       = PARSE_FUNCTIONS.find(data_type_str);
+        if (!parse_function_ptr) {
+            throw unknown_type_error("Unknown data type '" + std::string(data_type_str) + '\'');
         }
+    }
+
+    // convert a single value
+    const parse_function function = parse_function_ptr ? *parse_function_ptr : nullptr;
+    auto convert = [&](std::string_view single_value_str, std::size_t address) -> Instructions {
+        return convert_value(type, address, single_value_str, function, base_value, verbose);
+    };
+
+    // single value: the address is saturated (see Instruction), the registers of the value do not wrap around
+    if (!is_range && !is_list && !is_hex) {
+        const auto address = std::min<unsigned long long>(addr, Instruction::MAX_ADDRESS);
+        out                = convert(value_str, static_cast<std::size_t>(address));
+        return;
+    }
+
+    // block write (all addresses of the block have to be representable, see Instruction::MAX_ADDRESS)
+    if (addr > Instruction::MAX_ADDRESS || (is_range && addr_end > Instruction::MAX_ADDRESS))
+        throw std::invalid_argument("Address out of range '" + std::string(addr_str) + '\'');
+
+    BlockInstruction block(out.get_resource());
+    block.register_type = type;
+    block.address       = static_cast<std::size_t>(addr);
+
+    if (is_hex) {
+        const bool coils = type == Instruction::register_type_t::DO || type == Instruction::register_type_t::DI;
+        parse_hex_data(split_input[3], coils, block.pattern);
+    } else {
+        auto append_value = [&](std::string_view single_value_str) {
+            for (const auto &instruction : convert(single_value_str, block.address + block.pattern.size()))
+                block.pattern.push_back(instruction.value);
+        };
+
+        if (is_list) {
+            block.pattern.reserve(static_cast<std::size_t>(std::count(value_str.begin(), value_str.end(), ',')) + 1);
+            for_each_field(value_str.substr(1, value_str.size() - 2), LIST_DELIMITER, [&](std::string_view list_elem) {
+                const auto list_elem_str = trim(list_elem);
+                if (list_elem_str.empty()) throw std::invalid_argument("Empty value in list");
+                append_value(list_elem_str);
+                return true;
+            });
+        } else {
+            append_value(value_str);
+        }
+    }
+
+    if (!is_range && block.pattern.size() - 1 > Instruction::MAX_ADDRESS - block.address)
+        throw std::invalid_argument("Address out of range '" + std::string(addr_str) + '\'');
+
+    block.count = is_range ? static_cast<std::size_t>(addr_end - addr + 1) : block.pattern.size();
+    if (block.count % block.pattern.size() != 0) {
+        throw std::invalid_argument("The size of the address range is not a multiple of the number of registers");
+    }
+
+    out.set_block(std::move(block));
+}
+
+Template compile_template(std::string_view definition, int base_addr, int base_value) {
+    static constexpr std::string_view PARAMETER   = "$1";
+    static constexpr std::string_view PLACEHOLDER = "0";
+    static constexpr std::size_t      VALUE_FIELD = 2;
+
+    // fields of the definition (without the prefix of the modbus_conv_float compatibility)
+    const bool compat_float = definition.size() >= 2 && to_lower(definition[0]) == 'f' && definition[1] == ':';
+    std::array<std::string_view, 5> fields {};
+    std::size_t                     elements = 0;
+    for_each_field(compat_float ? definition.substr(2) : definition, ':', [&](std::string_view field) {
+        if (elements < fields.size()) fields[elements] = field;
+        ++elements;
+        return true;
+    });
+
+    Template tpl;
+    tpl.parameter = fields[VALUE_FIELD] == PARAMETER;
+
+    if (!tpl.parameter) {
+        if (definition.find(PARAMETER) != std::string_view::npos)
+            throw std::invalid_argument("The parameter $1 is only possible as value");
+
+        parse(definition, tpl.instructions, base_addr, base_value);
+        if (const auto &block = tpl.instructions.get_block()) {
+            tpl.register_type = block->register_type;
+            tpl.address       = block->address;
+            tpl.registers     = block->count;
+        } else {
+            auto [min, max] = std::minmax_element(
+                    tpl.instructions.begin(), tpl.instructions.end(), [](const auto &a, const auto &b) {
+                        return a.address < b.address;
+                    });
+            tpl.register_type = min->register_type;
+            tpl.address       = min->address;
+            tpl.registers     = max->address - min->address + 1;
+        }
+        return tpl;
+    }
+
+    // the definition is checked (and the number of registers is determined) with a placeholder value
+    std::string check(definition);
+    check.replace(check.find(PARAMETER), PARAMETER.size(), PLACEHOLDER);
+    Instructions instructions;
+    parse(check, instructions, base_addr);
+    if (instructions.get_block()) {
+        throw std::invalid_argument("Address ranges are not possible with the parameter $1");
+    }
+
+    tpl.register_type = instructions[0].register_type;
+    tpl.address       = instructions[0].address;
+    tpl.registers     = instructions.size();
+
+    if (compat_float || (elements > VALUE_FIELD + 1 && !fields[VALUE_FIELD + 1].empty())) {
+        static constexpr std::string_view COMPAT_DATA_TYPE = "f32_badc";
+        const auto  data_type = compat_float ? COMPAT_DATA_TYPE : fields[VALUE_FIELD + 1];
+        const auto *function  = PARSE_FUNCTIONS.find(data_type);
+        const auto *encode    = ENCODE_FUNCTIONS.find(data_type);
+        if (!function || !encode) throw unknown_type_error("Unknown data type");  // not reachable: checked by parse
+        tpl.function = *function;
+        tpl.encode   = *encode;
+    }
+
+    return tpl;
+}
+
+void expand_template(const Template &tpl, std::string_view value, Instructions &out, int base_value, bool verbose) {
+    if (!tpl.parameter) {
+        out = tpl.instructions;
+        return;
+    }
+
+    out = convert_value(tpl.register_type, tpl.address, trim(value), tpl.function, base_value, verbose);
+}
+
+void encode_template(const Template &tpl, double value, Instructions &out) {
+    if (tpl.encode) {
+        out = tpl.encode(tpl.register_type, tpl.address, value);
+        return;
+    }
 
-        return PARSE_FUNCTIONS.at(split_input[3])(type, addr, value_str, base_value, verbose);
+    // no data type --> single register
+    out.clear();
+    switch (tpl.register_type) {
+        case Instruction::register_type_t::DO:
+        case Instruction::register_type_t::DI:
+            out.push_back(Instruction(tpl.register_type, tpl.address, std::fabs(value) >= 0.5 ? 1 : 0));
+            break;
+        case Instruction::register_type_t::AO:
+        case Instruction::register_type_t::AI:
+            out.push_back(Instruction(tpl.register_type, tpl.address, saturate_cast<uint16_t>(value)));
+            break;
     }
 }
 
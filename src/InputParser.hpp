@@ -5,9 +5,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
-#include <string>
+#include <initializer_list>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace InputParser {
@@ -20,17 +28,35 @@ static constexpr const char *PHI   = "1.61803398874989484820";
 static constexpr const char *LN2   = "0.69314718055994530941";
 static constexpr const char *E     = "2.71828182845904523536";
 
+/**
+ * @brief exception that is thrown if a line contains an unknown register type or data type
+ */
+class unknown_type_error : public std::invalid_argument {
+public:
+    using std::invalid_argument::invalid_argument;
+};
+
 /**
  * @brief modbus write instruction
+ *
+ * @details
+ * Packed to 8 bytes (register type, value, address). Addresses that do not fit into 32 bits are saturated: they are
+ * out of range for every shared memory.
  */
 struct Instruction {
     /**
      * @brief lists of all possible register types
      */
-    enum class register_type_t { DO, DI, AO, AI };
-    register_type_t register_type;  //*< register type
-    std::size_t     address;        //*< register address
-    uint16_t        value;          //*< register value (will be converted to bool for DO and DI register type)
+    enum class register_type_t : uint8_t { DO, DI, AO, AI };
+
+    //* highest address that can be represented (larger addresses are saturated)
+    static constexpr std::size_t MAX_ADDRESS = std::numeric_limits<uint32_t>::max();
+
+    register_type_t register_type = register_type_t::DO;  //*< register type
+    uint16_t        value         = 0;  //*< register value (will be converted to bool for DO and DI register type)
+    uint32_t        address       = 0;  //*< register address
+
+    Instruction() = default;
 
     /**
      * @brief initialize all values
@@ -39,16 +65,194 @@ struct Instruction {
      * @param value register value
      */
     Instruction(register_type_t register_type, std::size_t address, uint16_t value)
-        : register_type(register_type), address(address), value(value) {}
+        : register_type(register_type), value(value),
+          address(static_cast<uint32_t>(std::min(address, MAX_ADDRESS))) {}
+};
+
+static_assert(sizeof(Instruction) == 8);
+
+/**
+ * @brief modbus write instruction for a contiguous block of registers
+ *
+ * @details
+ * The pattern is repeated until count registers are written. count is always a multiple of the pattern size.
+ */
+struct BlockInstruction {
+    Instruction::register_type_t register_type = Instruction::register_type_t::DO;  //*< register type
+    std::size_t                  address       = 0;                                 //*< start address
+    std::size_t                  count         = 0;                                 //*< number of registers
+    std::pmr::vector<uint16_t> pattern;  //*< register values (will be converted to bool for DO and DI register type)
+
+    BlockInstruction() = default;
+
+    /**
+     * @brief create block instruction with the pattern allocated from a memory resource
+     * @param resource memory resource (has to outlive the block instruction)
+     */
+    explicit BlockInstruction(std::pmr::memory_resource *resource) : pattern(resource) {}
+};
+
+/**
+ * @brief fixed capacity list of modbus write instructions
+ *
+ * @details
+ * Holds all instructions that result from a single input line (at most 4 registers for 64 bit data types).
+ * No heap memory is allocated, unless the line contains a block write (see BlockInstruction). The pattern of a block
+ * write is allocated from the memory resource of the list (e.g. an arena that is released after each batch).
+ * Copies of the list allocate the pattern from the default memory resource.
+ */
+class Instructions {
+public:
+    //* maximum number of instructions per input line
+    static constexpr std::size_t CAPACITY = 4;
+
+private:
+    std::array<Instruction, CAPACITY> instructions {};
+    std::size_t                       count = 0;
+    std::optional<BlockInstruction>   block;
+    std::pmr::memory_resource        *resource = std::pmr::get_default_resource();
+
+public:
+    Instructions() = default;
+
+    /**
+     * @brief create empty list that allocates block patterns from a memory resource
+     * @param resource memory resource (has to outlive the block instruction)
+     */
+    explicit Instructions(std::pmr::memory_resource *resource) : resource(resource) {}
+
+    /**
+     * @brief initialize with a list of instructions
+     * @param list instructions
+     *
+     * @exception std::length_error thrown if the capacity is exceeded
+     */
+    Instructions(std::initializer_list<Instruction> list) {
+        for (const auto &instruction : list)
+            push_back(instruction);
+    }
+
+    /**
+     * @brief append an instruction
+     * @param instruction instruction to append
+     *
+     * @exception std::length_error thrown if the capacity is exceeded
+     */
+    void push_back(const Instruction &instruction) {
+        if (count >= CAPACITY) throw std::length_error("too many instructions");
+        instructions[count++] = instruction;
+    }
+
+    /**
+     * @brief set block write instruction
+     * @param block_instruction block write instruction
+     */
+    void set_block(BlockInstruction block_instruction) { block.emplace(std::move(block_instruction)); }
+
+    //* remove all instructions
+    void clear() {
+        count = 0;
+        block.reset();
+    }
+
+    //* number of single register instructions
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] bool        empty() const { return count == 0 && !block; }
+
+    //* memory resource for the pattern of block write instructions
+    [[nodiscard]] std::pmr::memory_resource *get_resource() const { return resource; }
+
+    //* block write instruction (if any)
+    [[nodiscard]] const std::optional<BlockInstruction> &get_block() const { return block; }
+
+    [[nodiscard]] const Instruction &operator[](std::size_t index) const { return instructions[index]; }
+
+    [[nodiscard]] const Instruction *begin() const { return instructions.data(); }
+    [[nodiscard]] const Instruction *end() const { return instructions.data() + count; }
 };
 
 /**
  * @brief convert instruction line to list of modbus write instructions
+ *
+ * @details
+ * The line is not modified or copied. Upper and lower case are treated equally.
+ *
+ * Block writes (address range "start..end", value list "[v1,v2,...]" or raw data "hex:DEADBEEF") result in a
+ * single BlockInstruction.
+ *
  * @param line input instruction line
+ * @param out list that receives the instructions (cleared before parsing)
+ * @param base_addr numerical base for converting addresses
+ * @param base_value numerical base for converting values
+ *
+ * @exception std::invalid_argument thrown if the line is not a valid instruction
+ * @exception unknown_type_error thrown if the line contains an unknown register type or data type
+ */
+void parse(std::string_view line, Instructions &out, int base_addr = 0, int base_value = 0, bool verbose = false);
+
+//* conversion of a value string to instructions (register type, address, value string, numerical base, verbose)
+typedef Instructions (*parse_function)(Instruction::register_type_t, std::size_t, std::string_view, int, bool);
+
+//* conversion of a numerical value to instructions (register type, address, value)
+typedef Instructions (*encode_function)(Instruction::register_type_t, std::size_t, double);
+
+/**
+ * @brief precompiled instruction line (see --define)
+ *
+ * @details
+ * Register type, address and data type are resolved once by compile_template.
+ * If the value of the definition is the parameter $1, only the value is converted by expand_template.
+ * Otherwise, the instructions are precompiled completely.
+ */
+struct Template {
+    Instruction::register_type_t register_type = Instruction::register_type_t::DO;  //*< register type
+    std::size_t                  address       = 0;                                 //*< (start) address
+    std::size_t                  registers     = 0;        //*< number of registers that are written
+    bool                         parameter     = false;    //*< the value is the parameter $1
+    parse_function               function      = nullptr;  //*< value conversion (nullptr: value without data type)
+    encode_function              encode        = nullptr;  //*< numerical value conversion (nullptr: no data type)
+    Instructions                 instructions;             //*< instructions (only if there is no parameter)
+};
+
+/**
+ * @brief compile an instruction line to a template
+ *
+ * @details
+ * The definition has the syntax of an instruction line. The value can be replaced by the parameter $1.
+ * Address ranges, value lists and hex data are only possible without parameter.
+ *
+ * @param definition instruction line
  * @param base_addr numerical base for converting addresses
+ * @param base_value numerical base for converting values (only used if there is no parameter)
+ * @return compiled template
+ *
+ * @exception std::invalid_argument thrown if the definition is not valid
+ */
+Template compile_template(std::string_view definition, int base_addr = 0, int base_value = 0);
+
+/**
+ * @brief create the instructions of a template
+ * @param tpl template
+ * @param value value of the parameter $1 (ignored if the template has no parameter)
+ * @param out list that receives the instructions
  * @param base_value numerical base for converting values
- * @return list of instructions
+ *
+ * @exception std::invalid_argument thrown if the value is not valid
+ */
+void expand_template(
+        const Template &tpl, std::string_view value, Instructions &out, int base_value = 0, bool verbose = false);
+
+/**
+ * @brief create the instructions of a template from a numerical value (no string conversion, see generators)
+ *
+ * @details
+ * Integers are rounded and saturated to the range of the data type. Without data type, a single register (0..65535)
+ * is written. Coils are set if the rounded value is not 0.
+ *
+ * @param tpl template (with parameter)
+ * @param value value of the parameter $1
+ * @param out list that receives the instructions
  */
-std::vector<Instruction> parse(std::string line, int base_addr = 0, int base_value = 0, bool verbose = false);
+void encode_template(const Template &tpl, double value, Instructions &out);
 
 }  // namespace InputParser
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+#include "InputParser_float.hpp"
+#include "InputParser_int.hpp"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace InputParser {
+
+//* byte order of a value in the shared memory
+enum class ByteOrder { BIG, LITTLE };
+
+//* order of the registers of a multi register value in the shared memory
+enum class WordOrder { NORMAL, REVERSED };
+
+//* position of a single byte value within a register (low or high byte in host byte order)
+enum class BytePosition { LOW, HIGH };
+
+/**
+ * @brief unsigned integer type with the same size as T
+ * @tparam T data type
+ */
+template <typename T>
+using uint_of_size_t = std::conditional_t<
+        sizeof(T) == sizeof(uint8_t),
+        uint8_t,
+        std::conditional_t<sizeof(T) == sizeof(uint16_t),
+                           uint16_t,
+                           std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>>>;
+
+/**
+ * @brief reverse the byte order of an unsigned integer
+ * @param value value
+ * @return value with reversed byte order
+ */
+template <typename U>
+static constexpr U byteswap(U value) {
+    static_assert(std::is_unsigned_v<U>);
+    if constexpr (sizeof(U) == sizeof(uint8_t)) return value;
+    else if constexpr (sizeof(U) == sizeof(uint16_t)) return __builtin_bswap16(value);
+    else if constexpr (sizeof(U) == sizeof(uint32_t)) return __builtin_bswap32(value);
+    else
+        return __builtin_bswap64(value);
+}
+
+/**
+ * @brief convert string to a value of type T
+ *
+ * @param value string value to convert
+ * @param base numerical base (ignored for floating point values)
+ * @return converted value
+ *
+ * @exception std::invalid_argument thrown if the value is not a valid number or out of range
+ */
+template <typename T>
+static T parse_number(std::string_view value, int base) {
+    if constexpr (std::is_same_v<T, float>) return parse_float(value);
+    else if constexpr (std::is_same_v<T, double>) return parse_double(value);
+    else
+        return parse_int<T>(value, base);
+}
+
+/**
+ * @brief convert a floating point value to a value of type T
+ *
+ * @details
+ * Integers are rounded to the nearest value and saturated to the range of T. NaN is converted to 0.
+ *
+ * @param value value to convert
+ * @return converted value
+ */
+template <typename T>
+static T saturate_cast(double value) {
+    if constexpr (std::is_floating_point_v<T>) return static_cast<T>(value);
+    else {
+        if (std::isnan(value)) return 0;
+        if (value <= static_cast<double>(std::numeric_limits<T>::min())) return std::numeric_limits<T>::min();
+        if (value >= static_cast<double>(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+        return static_cast<T>(std::round(value));
+    }
+}
+
+/**
+ * @brief print a description of the data type T (e.g. "signed integer 32 bit")
+ * @param o output stream
+ */
+template <typename T>
+static void describe_type(std::ostream &o) {
+    if constexpr (std::is_floating_point_v<T>) o << "float ";
+    else if constexpr (std::is_signed_v<T>) o << "signed integer ";
+    else
+        o << "unsigned integer ";
+    o << std::dec << sizeof(T) * 8 << " bit";
+}
+
+/**
+ * @brief encodes a value of type T into modbus registers
+ *
+ * @details
+ * The resulting registers contain the bytes of the value in the specified byte order.
+ * For values with more than one register, the order of the registers can be reversed.
+ * All decisions are made at compile time.
+ *
+ * @tparam T data type (16, 32 or 64 bit integer or floating point)
+ * @tparam ENDIAN byte order of the value in the shared memory
+ * @tparam REGISTER_ORDER register order of the value in the shared memory
+ */
+template <typename T, ByteOrder ENDIAN, WordOrder REGISTER_ORDER>
+struct codec {
+    static_assert(sizeof(T) % sizeof(uint16_t) == 0, "size of T must be a multiple of the register size");
+
+    using value_type = T;
+
+    //* number of registers
+    static constexpr std::size_t REGISTERS = sizeof(T) / sizeof(uint16_t);
+
+    /**
+     * @brief write value to registers
+     * @param value value to encode
+     * @param registers target registers
+     */
+    static constexpr void encode(T value, std::span<uint16_t, REGISTERS> registers) {
+        using raw_t = uint_of_size_t<T>;
+
+        auto raw = std::bit_cast<raw_t>(value);
+        if constexpr ((ENDIAN == ByteOrder::BIG) != (std::endian::native == std::endian::big)) {
+            raw = byteswap(raw);
+        }
+
+        auto words = std::bit_cast<std::array<uint16_t, REGISTERS>>(raw);
+        for (std::size_t i = 0; i < REGISTERS; ++i) {
+            if constexpr (REGISTER_ORDER == WordOrder::REVERSED) registers[i] = words[REGISTERS - 1 - i];
+            else
+                registers[i] = words[i];
+        }
+    }
+
+    /**
+     * @brief print a description of the encoding
+     * @param o output stream
+     */
+    static void describe(std::ostream &o) {
+        o << (ENDIAN == ByteOrder::BIG ? "big" : "little") << " endian ";
+        describe_type<T>(o);
+        if (REGISTER_ORDER == WordOrder::REVERSED && REGISTERS > 1) o << " (reversed register order)";
+    }
+};
+
+/**
+ * @brief encodes an 8 bit value into one byte of a modbus register
+ *
+ * @details
+ * The other byte of the register is set to 0.
+ *
+ * @tparam T data type (8 bit integer)
+ * @tparam POSITION target byte in the register
+ */
+template <typename T, BytePosition POSITION>
+struct byte_codec {
+    static_assert(sizeof(T) == sizeof(uint8_t));
+
+    using value_type = T;
+
+    //* number of registers
+    static constexpr std::size_t REGISTERS = 1;
+
+    /**
+     * @brief write value to register
+     * @param value value to encode
+     * @param registers target register
+     */
+    static constexpr void encode(T value, std::span<uint16_t, REGISTERS> registers) {
+        const auto byte = static_cast<uint16_t>(std::bit_cast<uint8_t>(value));
+
+        // the byte position refers to the memory layout of the register
+        if constexpr ((POSITION == BytePosition::LOW) == (std::endian::native == std::endian::little)) {
+            registers[0] = byte;
+        } else {
+            registers[0] = static_cast<uint16_t>(byte << 8);
+        }
+    }
+
+    /**
+     * @brief print a description of the encoding
+     * @param o output stream
+     */
+    static void describe(std::ostream &o) {
+        o << (POSITION == BytePosition::LOW ? "low" : "high") << " byte ";
+        describe_type<T>(o);
+    }
+};
+
+/**
+ * @brief print a converted value to stderr (verbose output of parse_value)
+ *
+ * @details
+ * Not inlined: the parse functions do not contain any output code.
+ *
+ * @tparam CODEC codec (see codec and byte_codec)
+ * @param value_host converted value
+ */
+template <typename CODEC>
+[[gnu::noinline, gnu::cold]] static void print_value(typename CODEC::value_type value_host) {
+    using value_t = typename CODEC::value_type;
+
+    std::cerr << "# ";
+    CODEC::describe(std::cerr);
+    std::cerr << ": ";
+    if constexpr (std::is_floating_point_v<value_t>) {
+        std::cerr << std::dec << std::setprecision(std::numeric_limits<value_t>::digits10) << value_host;
+    } else {
+        std::cerr << std::dec << +value_host;
+    }
+    std::cerr << '\n';
+}
+
+/**
+ * @brief get instructions for a value that is encoded with the given codec
+ *
+ * @tparam CODEC codec (see codec and byte_codec)
+ * @param type register type
+ * @param addr start address
+ * @param value string to convert
+ * @param base numerical base (ignored for floating point values)
+ * @param verbose print converted value to stderr
+ * @return list of instructions
+ *
+ * @exception std::invalid_argument thrown if the value is not a valid number or out of range
+ */
+template <typename CODEC>
+static Instructions parse_value(
+        Instruction::register_type_t type, std::size_t addr, std::string_view value, int base, bool verbose) {
+    static_assert(CODEC::REGISTERS <= Instructions::CAPACITY);
+
+    using value_t = typename CODEC::value_type;
+
+    const auto value_host = parse_number<value_t>(value, base);
+
+    std::array<uint16_t, CODEC::REGISTERS> registers {};
+    CODEC::encode(value_host, registers);
+
+    if (verbose) [[unlikely]]
+        print_value<CODEC>(value_host);
+
+    Instructions instructions;
+    for (std::size_t i = 0; i < CODEC::REGISTERS; ++i)
+        instructions.push_back(Instruction(type, addr + i, registers[i]));
+    return instructions;
+}
+
+/**
+ * @brief get instructions for a numerical value that is encoded with the given codec (no string conversion)
+ *
+ * @tparam CODEC codec (see codec and byte_codec)
+ * @param type register type
+ * @param addr start address
+ * @param value value (see saturate_cast)
+ * @return list of instructions
+ */
+template <typename CODEC>
+static Instructions encode_value(Instruction::register_type_t type, std::size_t addr, double value) {
+    static_assert(CODEC::REGISTERS <= Instructions::CAPACITY);
+
+    std::array<uint16_t, CODEC::REGISTERS> registers {};
+    CODEC::encode(saturate_cast<typename CODEC::value_type>(value), registers);
+
+    Instructions instructions;
+    for (std::size_t i = 0; i < CODEC::REGISTERS; ++i)
+        instructions.push_back(Instruction(type, addr + i, registers[i]));
+    return instructions;
+}
+
+}  // namespace InputParser
@@ -5,19 +5,64 @@
 
 #pragma once
 
-#include "InputParser.hpp"
+#include "InputParser_string.hpp"
 
-#include "InputParser_float.hpp"
-
-#include <cxxendian.hpp>
-#include <iomanip>
-#include <iostream>
+#include <charconv>
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace InputParser {
 
+/**
+ * @brief convert string to floating point value
+ *
+ * @details
+ * Accepts the same input as std::strtod (leading whitespace, optional sign, decimal and hexadecimal (0x prefix)
+ * notation, inf, nan), but does not depend on the current locale.
+ * The complete string has to be a valid number.
+ * The conversion is done by std::from_chars, which is correctly rounded (libstdc++ uses the Eisel-Lemire algorithm
+ * of fast_float since GCC 12).
+ *
+ * @tparam T floating point type
+ * @param value string value to convert
+ * @param result converted value
+ * @return true on success, false if the string is not a valid number or the number is out of range
+ */
+template <typename T>
+static inline bool parse_floating_point(std::string_view value, T &result) {
+    std::size_t pos = 0;
+    while (pos < value.size() && is_space(value[pos]))
+        ++pos;
+
+    bool negative = false;
+    if (pos < value.size() && (value[pos] == '+' || value[pos] == '-')) {
+        negative = value[pos] == '-';
+        ++pos;
+    }
+
+    auto format = std::chars_format::general;
+    if (value.size() - pos > 2 && value[pos] == '0' && to_lower(value[pos + 1]) == 'x') {
+        format = std::chars_format::hex;
+        pos += 2;
+    }
+
+    const char *first = value.data() + pos;
+    const char *last  = value.data() + value.size();
+    if (first == last) return false;
+
+    // sign was already consumed
+    if (*first == '-') return false;
+
+    const auto [ptr, ec] = std::from_chars(first, last, result, format);
+    if (ec != std::errc() || ptr != last) return false;
+
+    if (negative) result = -result;
+    return true;
+}
+
 /* =====================================================================================================================
  * =====================================================================================================================
  * FLOAT 32 Bit (float)
@@ -41,148 +86,33 @@ namespace InputParser {
  * @param value string value to convert
  * @return float value
  */
-static float parse_float(const std::string &value) {
+static inline float parse_float(std::string_view value) {
     static_assert(std::numeric_limits<float>::is_iec559, "IEEE 754 required");
 
     typedef float float_t;
 
-    if (value == "nan") {
+    if (iequals(value, "nan")) {
         return std::numeric_limits<float_t>::quiet_NaN();
-    } else if (value == "inf") {
+    } else if (iequals(value, "inf")) {
         return std::numeric_limits<float_t>::infinity();
-    } else if (value == "-inf") {
+    } else if (iequals(value, "-inf")) {
         return -std::numeric_limits<float_t>::infinity();
-    } else if (value == "min") {
-        std::numeric_limits<float_t>::min();
-    } else if (value == "max") {
-        std::numeric_limits<float_t>::max();
-    } else if (value == "epsilon") {
-        std::numeric_limits<float_t>::epsilon();
-    } else if (value == "lowest") {
-        std::numeric_limits<float_t>::lowest();
+    } else if (iequals(value, "min")) {
+        return std::numeric_limits<float_t>::min();
+    } else if (iequals(value, "max")) {
+        return std::numeric_limits<float_t>::max();
+    } else if (iequals(value, "epsilon")) {
+        return std::numeric_limits<float_t>::epsilon();
+    } else if (iequals(value, "lowest")) {
+        return std::numeric_limits<float_t>::lowest();
     }
 
-    float       ret;
-    bool        fail = false;
-    std::size_t idx  = 0;
-
-    try {
-        ret = std::stof(value, &idx);
-    } catch (const std::exception &) { fail = true; }
-    fail = fail || idx != value.size();
-
-    if (fail) throw std::invalid_argument("Failed to parse value '" + value + '\'');
-
-    return ret;
-}
-
-/**
- * @brief get Instructions for a big endian float
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-
-static std::vector<Instruction> parse_f32abcd(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<float> hf(parse_float(value));
-    cxxendian::BE_Float<float>   bf(hf);
-
-    union {
-        uint16_t reg[2];
-        float    f;
-    };
-
-    f = bf.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<float>::digits10);
-        std::cerr << "# big endian float 32: " << hf << std::endl;
-    }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
-}
-
-/**
- * @brief get Instructions for a big endian float (reversed register order)
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f32cdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<float> hf(parse_float(value));
-    cxxendian::BE_Float<float>   bf(hf);
-
-    union {
-        uint16_t reg[2];
-        float    f;
-    };
-
-    f = bf.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<float>::digits10);
-        std::cerr << "# big endian float 32 (reversed register order): " << hf << std::endl;
+    float_t ret {};
+    if (!parse_floating_point(value, ret)) {
+        throw std::invalid_argument("Failed to parse value '" + std::string(value) + '\'');
     }
 
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
-}
-
-/**
- * @brief get Instructions for a little endian float
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f32dcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<float> hf(parse_float(value));
-    cxxendian::LE_Float<float>   lf(hf);
-
-    union {
-        uint16_t reg[2];
-        float    f;
-    };
-
-    f = lf.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<float>::digits10);
-        std::cerr << "# little endian float 32: " << hf << std::endl;
-    }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
-}
-
-/**
- * @brief get Instructions for a little endian float (reversed register order)
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f32badc(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<float> hf(parse_float(value));
-    cxxendian::LE_Float<float>   lf(hf);
-
-    union {
-        uint16_t reg[2];
-        float    f;
-    };
-
-    f = lf.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<float>::digits10);
-        std::cerr << "# little endian floating point 32 bit (reversed register order): " << hf << std::endl;
-    }
-
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
+    return ret;
 }
 
 /* =====================================================================================================================
@@ -208,160 +138,33 @@ static std::vector<Instruction> parse_f32badc(
  * @param value string value to convert
  * @return double value
  */
-static double parse_double(const std::string &value) {
-    static_assert(std::numeric_limits<float>::is_iec559, "IEEE 754 required");
+static inline double parse_double(std::string_view value) {
+    static_assert(std::numeric_limits<double>::is_iec559, "IEEE 754 required");
 
     typedef double float_t;
 
-    if (value == "nan") {
+    if (iequals(value, "nan")) {
         return std::numeric_limits<float_t>::quiet_NaN();
-    } else if (value == "inf") {
+    } else if (iequals(value, "inf")) {
         return std::numeric_limits<float_t>::infinity();
-    } else if (value == "-inf") {
+    } else if (iequals(value, "-inf")) {
         return -std::numeric_limits<float_t>::infinity();
-    } else if (value == "min") {
-        std::numeric_limits<float_t>::min();
-    } else if (value == "max") {
-        std::numeric_limits<float_t>::max();
-    } else if (value == "epsilon") {
-        std::numeric_limits<float_t>::epsilon();
-    } else if (value == "lowest") {
-        std::numeric_limits<float_t>::lowest();
-    }
-
-    double      ret;
-    bool        fail = false;
-    std::size_t idx  = 0;
-
-    try {
-        ret = std::stod(value, &idx);
-    } catch (const std::exception &) { fail = true; }
-    fail = fail || idx != value.size();
-
-    if (fail) throw std::invalid_argument("Failed to parse value '" + value + '\'');
-
-    return ret;
-}
-
-/**
- * @brief get Instructions for a big endian double
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f64abcdefgh(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<double> hd(parse_double(value));
-    cxxendian::BE_Float<double>   bd(hd);
-
-    union {
-        uint16_t reg[4];
-        double   d;
-    };
-
-    d = bd.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<double>::digits10);
-        std::cerr << "# big endian float 64: " << hd << std::endl;
-    }
-
-    return {Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3])};
-}
-
-/**
- * @brief get Instructions for a little endian double
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f64hgfedcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<double> hd(parse_double(value));
-    cxxendian::LE_Float<double>   ld(hd);
-
-    union {
-        uint16_t reg[4];
-        double   d;
-    };
-
-    d = ld.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<double>::digits10);
-        std::cerr << "# little endian float 64: " << hd << std::endl;
-    }
-
-    return {Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3])};
-}
-
-/**
- * @brief get Instructions for a big endian double (reversed register order)
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f64ghefcdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<double> hd(parse_double(value));
-    cxxendian::BE_Float<double>   bd(hd);
-
-    union {
-        uint16_t reg[4];
-        double   d;
-    };
-
-    d = bd.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<double>::digits10);
-        std::cerr << "# big endian float 64 (reversed register order): " << hd << std::endl;
+    } else if (iequals(value, "min")) {
+        return std::numeric_limits<float_t>::min();
+    } else if (iequals(value, "max")) {
+        return std::numeric_limits<float_t>::max();
+    } else if (iequals(value, "epsilon")) {
+        return std::numeric_limits<float_t>::epsilon();
+    } else if (iequals(value, "lowest")) {
+        return std::numeric_limits<float_t>::lowest();
     }
 
-    return {Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0])};
-}
-
-/**
- * @brief get Instructions for a little endian double (reversed register order)
- * @param type register type
- * @param addr start address
- * @param value string to convert
- * @return list of instructions
- */
-static std::vector<Instruction> parse_f64badcfehg(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int, bool verbose) {
-    cxxendian::Host_Float<double> hd(parse_double(value));
-    cxxendian::LE_Float<double>   ld(hd);
-
-    union {
-        uint16_t reg[4];
-        double   d;
-    };
-
-    d = ld.get();
-
-    if (verbose) {
-        std::cerr << std::setprecision(std::numeric_limits<double>::digits10);
-        std::cerr << "# big endian float 64 (reversed register order): " << hd << std::endl;
+    float_t ret {};
+    if (!parse_floating_point(value, ret)) {
+        throw std::invalid_argument("Failed to parse value '" + std::string(value) + '\'');
     }
 
-    return {Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0])};
+    return ret;
 }
 
-
 }  // namespace InputParser
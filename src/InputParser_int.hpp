@@ -5,11 +5,16 @@
 
 #pragma once
 
+#include "InputParser_string.hpp"
+
+#include <bit>
+#include <charconv>
 #include <cstdint>
-#include <cxxendian.hpp>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 static_assert(sizeof(unsigned long long) >= sizeof(uint64_t));
@@ -17,573 +22,292 @@ static_assert(sizeof(long long) >= sizeof(int64_t));
 
 namespace InputParser {
 
-template <class T, typename std::enable_if<std::is_integral<T> {} && !std::is_signed<T> {}, bool>::type = true>
-static T parse_int(const std::string &value, int base) {
-    if (value == "min") {
-        return std::numeric_limits<T>::min();
-    } else if (value == "max") {
-        return std::numeric_limits<T>::max();
-    } else if (value == "lowest") {
-        return std::numeric_limits<T>::lowest();
-    }
-
-    unsigned long long ret;
-    bool               fail = false;
-    std::size_t        idx  = 0;
-
-    try {
-        ret = std::stoull(value, &idx, base);
-    } catch (const std::exception &) { fail = true; }
-    fail = fail || idx != value.size();
-    fail = fail || ret > std::numeric_limits<T>::max();
-
-    if (fail) throw std::invalid_argument("Failed to parse value '" + value + '\'');
-
-    return static_cast<T>(ret);
-}
-
-template <class T, typename std::enable_if<std::is_integral<T> {} && std::is_signed<T> {}, bool>::type = true>
-static T parse_int(const std::string &value, int base) {
-    if (value == "min") {
-        return std::numeric_limits<T>::min();
-    } else if (value == "max") {
-        return std::numeric_limits<T>::max();
-    } else if (value == "lowest") {
-        return std::numeric_limits<T>::lowest();
-    }
-
-    long long   ret;
-    bool        fail = false;
-    std::size_t idx  = 0;
-
-    try {
-        ret = std::stoll(value, &idx, base);
-    } catch (const std::exception &) { fail = true; }
-    fail = fail || idx != value.size();
-    fail = fail || ret > std::numeric_limits<T>::max();
-    fail = fail || ret < std::numeric_limits<T>::min();
-
-    if (fail) throw std::invalid_argument("Failed to parse value '" + value + '\'');
-
-    return static_cast<T>(ret);
-}
+//* SWAR (8 characters per 64 bit word) conversion requires a little endian byte order
+static constexpr bool SWAR_DIGITS = std::endian::native == std::endian::little;
 
-/* =====================================================================================================================
- * =====================================================================================================================
- * 8 Bit
- * =====================================================================================================================
- * =====================================================================================================================
+/**
+ * @brief load 8 characters as 64 bit word (first character in the least significant byte)
+ * @param str 8 characters
+ * @return word
  */
-
-static std::vector<Instruction> parse_u8_lo(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    union {
-        uint16_t reg;
-        uint8_t  i[2];
-    };
-
-    i[0] = parse_int<uint8_t>(value, base);
-    i[1] = 0;
-
-    if (verbose) { std::cerr << "# low byte unsigned integer 32 bit: " << i[0] << std::endl; }
-
-    return {Instruction(type, addr, reg)};
-}
-
-static std::vector<Instruction> parse_u8_hi(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    union {
-        uint16_t reg;
-        uint8_t  i[2];
-    };
-
-    i[1] = parse_int<uint8_t>(value, base);
-    i[0] = 0;
-
-    if (verbose) { std::cerr << "# high byte unsigned integer 8 bit: " << i[1] << std::endl; }
-
-    return {Instruction(type, addr, reg)};
-}
-
-// low byte
-static std::vector<Instruction> parse_i8_lo(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    union {
-        uint16_t reg;
-        int8_t   i[2];
-    };
-
-    i[0] = parse_int<int8_t>(value, base);
-    i[1] = 0;
-
-    if (verbose) { std::cerr << "# low byte signed integer 8 bit: " << i[0] << std::endl; }
-
-    return {Instruction(type, addr, reg)};
-}
-
-// high byte
-static std::vector<Instruction> parse_i8_hi(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    union {
-        uint16_t reg;
-        int8_t   i[2];
-    };
-
-    i[1] = parse_int<int8_t>(value, base);
-    i[0] = 0;
-
-    if (verbose) { std::cerr << "# high byte signed integer 8 bit: " << i[1] << std::endl; }
-
-    return {Instruction(type, addr, reg)};
+static inline uint64_t load_8_chars(const char *str) {
+    uint64_t word {};
+    std::memcpy(&word, str, sizeof(word));
+    return word;
 }
 
-/* =====================================================================================================================
- * =====================================================================================================================
- * 16 Bit
- * =====================================================================================================================
- * =====================================================================================================================
+/**
+ * @brief check if 8 characters are decimal digits
+ * @param word characters (see load_8_chars)
+ * @return true if all characters are decimal digits
  */
-
-// big endian
-static std::vector<Instruction> parse_u16_ab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    cxxendian::Host_Int<uint16_t> hi(parse_int<uint16_t>(value, base));
-    cxxendian::BE_Int<uint16_t>   bi(hi);
-
-    if (verbose) { std::cerr << "# big endian unsigned integer 16 bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, bi.get())};
-}
-
-// little endian
-static std::vector<Instruction> parse_u16_ba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    cxxendian::Host_Int<uint16_t> hi(parse_int<uint16_t>(value, base));
-    cxxendian::LE_Int<uint16_t>   li(hi);
-
-    if (verbose) { std::cerr << "# little endian unsigned integer 16 bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, li.get())};
+static constexpr bool is_8_decimal_digits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0) | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
 }
 
-// big endian
-static std::vector<Instruction> parse_i16_ab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    cxxendian::Host_Int<int16_t> hi(parse_int<int16_t>(value, base));
-    cxxendian::BE_Int<int16_t>   bi(hi);
-
-    union {
-        uint16_t reg;
-        int16_t  i;
-    };
-
-    i = bi.get();
-
-    if (verbose) { std::cerr << "# big endian signed integer 16 bit: " << hi << std::endl; }
-
-    if (verbose) { std::cerr << std::endl; }
-
-    return {Instruction(type, addr, reg)};
-}
-
-// little endian
-static std::vector<Instruction> parse_i16_ba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    cxxendian::Host_Int<int16_t> hi(parse_int<int16_t>(value, base));
-    cxxendian::LE_Int<int16_t>   li(hi);
-
-    union {
-        uint16_t reg;
-        int16_t  i;
-    };
-
-    i = li.get();
-
-    if (verbose) { std::cerr << "# little endian signed integer 16 bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, reg)};
+/**
+ * @brief convert 8 decimal digits
+ * @param word decimal digits (see load_8_chars and is_8_decimal_digits)
+ * @return value (0 - 99999999)
+ */
+static constexpr uint32_t convert_8_decimal_digits(uint64_t word) {
+    word -= 0x3030303030303030;
+    word = word * 10 + (word >> 8);  // pairs of digits
+    word = ((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) +
+            ((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >>
+           32;
+    return static_cast<uint32_t>(word);
 }
 
-/* =====================================================================================================================
- * =====================================================================================================================
- * 32 Bit
- * =====================================================================================================================
- * =====================================================================================================================
+/**
+ * @brief check if 8 characters are hexadecimal digits (upper or lower case)
+ * @param word characters (see load_8_chars)
+ * @return true if all characters are hexadecimal digits
  */
+static constexpr bool is_8_hex_digits(uint64_t word) {
+    constexpr uint64_t ONES = 0x0101010101010101;
+    constexpr uint64_t HIGH = ONES * 0x80;
 
-// big endian
-static std::vector<Instruction> parse_u32abcd(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint32_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
+    if (word & HIGH) return false;  // not ASCII (the range checks below require bytes < 0x80)
 
-    union {
-        uint16_t reg[2];
-        int_t    i;
+    // bit 7 of every byte that is in the range [lo, hi]
+    auto in_range = [](uint64_t w, uint8_t lo, uint8_t hi) {
+        return (w + ONES * (0x80 - lo)) & ~(w + ONES * (0x7F - hi)) & HIGH;
     };
 
-    i = ei.get();
-
-    if (verbose) { std::cerr << "big endian unsigned integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
+    const uint64_t lower = word | (ONES * 0x20);
+    return (in_range(word, '0', '9') | in_range(lower, 'a', 'f')) == HIGH;
 }
 
-// little endian
-static std::vector<Instruction> parse_u32dcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint32_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) { std::cerr << "little endian unsigned integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
+/**
+ * @brief convert 8 hexadecimal digits
+ * @param word hexadecimal digits (see load_8_chars and is_8_hex_digits)
+ * @return value
+ */
+static constexpr uint32_t convert_8_hex_digits(uint64_t word) {
+    // value of every digit ('a' - 'f' and 'A' - 'F' have bit 6 set)
+    word = (word & 0x0F0F0F0F0F0F0F0F) + ((word >> 6) & 0x0101010101010101) * 9;
+
+    // combine the digits (the first digit is the most significant one)
+    word = ((word & 0x0F000F000F000F00) >> 8) | ((word & 0x000F000F000F000F) << 4);
+    word = ((word & 0x00FF000000FF0000) >> 16) | ((word & 0x000000FF000000FF) << 8);
+    word = ((word & 0x0000FFFF00000000) >> 32) | ((word & 0x000000000000FFFF) << 16);
+    return static_cast<uint32_t>(word);
 }
 
-// big endian reversed
-static std::vector<Instruction> parse_u32cdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint32_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "big endian unsigned integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+// characters "12345678", "89ABCdef" and "9990afAF" (first character in the least significant byte)
+static_assert(convert_8_decimal_digits(0x3837363534333231) == 12345678);
+static_assert(convert_8_hex_digits(0x6665644342413938) == 0x89ABCDEF);
+static_assert(is_8_decimal_digits(0x3030303030303039) && !is_8_decimal_digits(0x303030303030303A));
+static_assert(is_8_hex_digits(0x4641666130393939) && !is_8_hex_digits(0x3030303030303047));
+
+/**
+ * @brief convert a sequence of digits to an unsigned integer (same semantics as std::from_chars)
+ *
+ * @details
+ * Decimal and hexadecimal numbers are converted 8 digits at a time (SWAR), other bases use std::from_chars.
+ *
+ * @param first first digit
+ * @param last end of the digits
+ * @param base numerical base (2-36)
+ * @param result converted value
+ * @return true on success, false if the digits are not valid (or empty) or the number is out of range
+ */
+static bool parse_digits(const char *first, const char *last, int base, unsigned long long &result) {
+    static constexpr auto MAX = std::numeric_limits<unsigned long long>::max();
+    static constexpr int  HEX = 16;
+    static constexpr int  DEC = 10;
+
+    if (!SWAR_DIGITS || (base != DEC && base != HEX) || first == last) {
+        const auto [ptr, ec] = std::from_chars(first, last, result, base);
+        return ec == std::errc() && ptr == last;
     }
 
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
-}
-
-// little endian reversed
-static std::vector<Instruction> parse_u32badc(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint32_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "little endian unsigned integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+    unsigned long long value = 0;
+    if (base == DEC) {
+        static constexpr unsigned long long E8 = 100000000;
+
+        for (; last - first >= 8; first += 8) {
+            const auto word = load_8_chars(first);
+            if (!is_8_decimal_digits(word)) return false;
+            const auto digits = convert_8_decimal_digits(word);
+            if (value > (MAX - digits) / E8) return false;
+            value = value * E8 + digits;
+        }
+
+        for (; first != last; ++first) {
+            if (*first < '0' || *first > '9') return false;
+            const auto digit = static_cast<unsigned>(*first - '0');
+            if (value > (MAX - digit) / DEC) return false;
+            value = value * DEC + digit;
+        }
+    } else {
+        static constexpr int BITS = std::numeric_limits<unsigned long long>::digits;
+
+        for (; last - first >= 8; first += 8) {
+            const auto word = load_8_chars(first);
+            if (!is_8_hex_digits(word)) return false;
+            if (value >> (BITS - 32)) return false;
+            value = (value << 32) | convert_8_hex_digits(word);
+        }
+
+        for (; first != last; ++first) {
+            const char c = to_lower(*first);
+            unsigned   digit {};
+            if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                digit = static_cast<unsigned>(c - 'a' + DEC);
+            else
+                return false;
+            if (value >> (BITS - 4)) return false;
+            value = (value << 4) | digit;
+        }
     }
 
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
+    result = value;
+    return true;
 }
 
-// big endian
-static std::vector<Instruction> parse_i32abcd(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int32_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) { std::cerr << "big endian signed integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
-}
-
-// little endian
-static std::vector<Instruction> parse_i32dcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int32_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) { std::cerr << "little endian signed integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {Instruction(type, addr, reg[0]), Instruction(type, addr + 1, reg[1])};
-}
-
-// big endian reversed
-static std::vector<Instruction> parse_i32cdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int32_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "big endian signed integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+/**
+ * @brief convert string to an unsigned integer magnitude and sign
+ *
+ * @details
+ * Accepts the same input as std::strtoull:
+ *  - leading whitespace
+ *  - optional sign (+ or -)
+ *  - optional prefix 0x or 0X (base 16 or 0)
+ *  - base 0: octal if the number starts with 0, hexadecimal if the prefix 0x is present, decimal otherwise
+ *
+ * The complete string has to be a valid number.
+ *
+ * @param value string value to convert
+ * @param base numerical base (0 or 2-36)
+ * @param magnitude absolute value of the number
+ * @param negative true if the number has a negative sign
+ * @return true on success, false if the string is not a valid number or the number is out of range
+ */
+static bool parse_magnitude(std::string_view value, int base, unsigned long long &magnitude, bool &negative) {
+    static constexpr int MAX_BASE = 36;
+    if (base != 0 && (base < 2 || base > MAX_BASE)) return false;
+
+    std::size_t pos = 0;
+    while (pos < value.size() && is_space(value[pos]))
+        ++pos;
+
+    negative = false;
+    if (pos < value.size() && (value[pos] == '+' || value[pos] == '-')) {
+        negative = value[pos] == '-';
+        ++pos;
     }
 
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
-}
-
-// little endian reversed
-static std::vector<Instruction> parse_i32badc(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int32_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[2];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "little endian signed integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+    const bool hex_prefix = value.size() - pos > 2 && value[pos] == '0' && to_lower(value[pos + 1]) == 'x';
+    if ((base == 0 || base == 16) && hex_prefix) {
+        base = 16;
+        pos += 2;
+    } else if (base == 0) {
+        base = value.size() - pos > 1 && value[pos] == '0' ? 8 : 10;
     }
 
-    return {Instruction(type, addr, reg[1]), Instruction(type, addr + 1, reg[0])};
-}
-
-/* =====================================================================================================================
- * =====================================================================================================================
- * 64 Bit
- * =====================================================================================================================
- * =====================================================================================================================
- */
-
-// big endian
-static std::vector<Instruction> parse_u64abcdefgh(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint64_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
+    const char *first = value.data() + pos;
+    const char *last  = value.data() + value.size();
+    if (first == last) return false;
 
-    i = ei.get();
-
-    if (verbose) { std::cerr << "big endian unsigned integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {
-            Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3]),
-    };
+    return parse_digits(first, last, base, magnitude);
 }
 
-// little endian
-static std::vector<Instruction> parse_u64hgfedcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint64_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) { std::cerr << "little endian unsigned integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {
-            Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3]),
-    };
-}
-
-// big endian reversed
-static std::vector<Instruction> parse_u64ghefcdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint64_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "big endian unsigned integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
-    }
-
-    return {
-            Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0]),
-    };
+/**
+ * @brief convert string to unsigned long long (same semantics as std::strtoull)
+ *
+ * @details
+ * A negative number is negated in unsigned arithmetic.
+ *
+ * @param value string value to convert
+ * @param base numerical base (0 or 2-36)
+ * @param result converted value
+ * @return true on success, false if the string is not a valid number or the number is out of range
+ */
+static bool parse_ull(std::string_view value, int base, unsigned long long &result) {
+    bool negative {};
+    if (!parse_magnitude(value, base, result, negative)) return false;
+    if (negative) result = 0ULL - result;
+    return true;
 }
 
-// little endian reversed
-static std::vector<Instruction> parse_u64badcfehg(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef uint64_t           int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "little endian unsigned integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+/**
+ * @brief convert string to unsigned integer
+ *
+ * @details
+ * can also handle the constants min, max and lowest.
+ * A negative number is negated in unsigned arithmetic (see parse_ull) and has to fit into the target type.
+ *
+ * @param value string value to convert
+ * @param base numerical base
+ * @return integer value
+ *
+ * @exception std::invalid_argument thrown if the value is not a valid number or out of range
+ */
+template <class T, typename std::enable_if<std::is_integral<T> {} && !std::is_signed<T> {}, bool>::type = true>
+static T parse_int(std::string_view value, int base) {
+    if (iequals(value, "min")) {
+        return std::numeric_limits<T>::min();
+    } else if (iequals(value, "max")) {
+        return std::numeric_limits<T>::max();
+    } else if (iequals(value, "lowest")) {
+        return std::numeric_limits<T>::lowest();
     }
 
-    return {
-            Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0]),
-    };
-}
-
-// big endian
-static std::vector<Instruction> parse_i64abcdefgh(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int64_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) { std::cerr << "big endian signed integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
+    unsigned long long ret {};
+    bool               fail = !parse_ull(value, base, ret);
+    fail                    = fail || ret > std::numeric_limits<T>::max();
 
-    return {
-            Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3]),
-    };
-}
-
-// little endian
-static std::vector<Instruction> parse_i64hgfedcba(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int64_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
+    if (fail) throw std::invalid_argument("Failed to parse value '" + std::string(value) + '\'');
 
-    i = ei.get();
-
-    if (verbose) { std::cerr << "little endian signed integer " << sizeof(int_t) * 8 << " bit: " << hi << std::endl; }
-
-    return {
-            Instruction(type, addr, reg[0]),
-            Instruction(type, addr + 1, reg[1]),
-            Instruction(type, addr + 2, reg[2]),
-            Instruction(type, addr + 3, reg[3]),
-    };
+    return static_cast<T>(ret);
 }
 
-// big endian reversed
-static std::vector<Instruction> parse_i64ghefcdab(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int64_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::BE_Int<int_t>   ei(hi);
-
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
-
-    i = ei.get();
-
-    if (verbose) {
-        std::cerr << "big endian signed integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
+/**
+ * @brief convert string to signed integer
+ *
+ * @details
+ * can also handle the constants min, max and lowest.
+ *
+ * @param value string value to convert
+ * @param base numerical base
+ * @return integer value
+ *
+ * @exception std::invalid_argument thrown if the value is not a valid number or out of range
+ */
+template <class T, typename std::enable_if<std::is_integral<T> {} && std::is_signed<T> {}, bool>::type = true>
+static T parse_int(std::string_view value, int base) {
+    if (iequals(value, "min")) {
+        return std::numeric_limits<T>::min();
+    } else if (iequals(value, "max")) {
+        return std::numeric_limits<T>::max();
+    } else if (iequals(value, "lowest")) {
+        return std::numeric_limits<T>::lowest();
     }
 
-    return {
-            Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0]),
-    };
-}
+    static constexpr auto MAX_MAGNITUDE = static_cast<unsigned long long>(std::numeric_limits<long long>::max());
 
-// little endian reversed
-static std::vector<Instruction> parse_i64badcfehg(
-        Instruction::register_type_t type, std::size_t addr, const std::string &value, int base, bool verbose) {
-    typedef int64_t            int_t;
-    cxxendian::Host_Int<int_t> hi(parse_int<int_t>(value, base));
-    cxxendian::LE_Int<int_t>   ei(hi);
+    unsigned long long magnitude {};
+    bool               negative {};
+    bool               fail = !parse_magnitude(value, base, magnitude, negative);
+    fail                    = fail || magnitude > MAX_MAGNITUDE + (negative ? 1 : 0);
 
-    union {
-        uint16_t reg[4];
-        int_t    i;
-    };
+    long long ret = 0;
+    if (!fail && negative) {
+        ret = magnitude > MAX_MAGNITUDE ? std::numeric_limits<long long>::min() : -static_cast<long long>(magnitude);
+    } else if (!fail) {
+        ret = static_cast<long long>(magnitude);
+    }
 
-    i = ei.get();
+    fail = fail || ret > std::numeric_limits<T>::max();
+    fail = fail || ret < std::numeric_limits<T>::min();
 
-    if (verbose) {
-        std::cerr << "little endian signed integer " << sizeof(int_t) * 8 << " bit (reversed register order): " << hi
-                  << std::endl;
-    }
+    if (fail) throw std::invalid_argument("Failed to parse value '" + std::string(value) + '\'');
 
-    return {
-            Instruction(type, addr, reg[3]),
-            Instruction(type, addr + 1, reg[2]),
-            Instruction(type, addr + 2, reg[1]),
-            Instruction(type, addr + 3, reg[0]),
-    };
+    return static_cast<T>(ret);
 }
 
 }  // namespace InputParser
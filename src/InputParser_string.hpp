@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace InputParser {
+
+/**
+ * @brief convert ASCII character to lower case (locale independent)
+ * @param c character
+ * @return lower case character
+ */
+static constexpr char to_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/**
+ * @brief compare string with a lower case string, ignoring the case of the first string
+ * @param str string to compare
+ * @param lower lower case string
+ * @return true if both strings are equal
+ */
+static constexpr bool iequals(std::string_view str, std::string_view lower) {
+    if (str.size() != lower.size()) return false;
+    for (std::size_t i = 0; i < str.size(); ++i)
+        if (to_lower(str[i]) != lower[i]) return false;
+    return true;
+}
+
+/**
+ * @brief check if a character is a whitespace character (same set as std::isspace in the "C" locale)
+ * @param c character
+ * @return true if c is a whitespace character
+ */
+static constexpr bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+}  // namespace InputParser
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
+namespace InputParser {
+
+/**
+ * @brief delimiter positions within a block of characters (SIMD)
+ *
+ * @details
+ * BLOCK_SIZE characters are compared at once. Each character is represented by BITS_PER_CHAR bits of the mask,
+ * exactly one of them (the lowest) is set if the character is the delimiter.
+ * Without SIMD support, BLOCK_SIZE is 0 and only the scalar loop of for_each_field is used.
+ */
+struct DelimiterBlock {
+#if defined(__AVX2__)
+    static constexpr std::size_t BLOCK_SIZE    = 32;
+    static constexpr std::size_t BITS_PER_CHAR = 1;
+
+    static uint64_t mask(const char *block, char delimiter) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));  // NOLINT
+        const auto equal = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(delimiter));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+    }
+#elif defined(__SSE2__)
+    static constexpr std::size_t BLOCK_SIZE    = 16;
+    static constexpr std::size_t BITS_PER_CHAR = 1;
+
+    static uint64_t mask(const char *block, char delimiter) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));  // NOLINT
+        const auto equal = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(delimiter));
+        return static_cast<uint32_t>(_mm_movemask_epi8(equal));
+    }
+#elif defined(__ARM_NEON)
+    static constexpr std::size_t BLOCK_SIZE    = 16;
+    static constexpr std::size_t BITS_PER_CHAR = 4;
+
+    static uint64_t mask(const char *block, char delimiter) {
+        const auto chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(block));  // NOLINT
+        const auto equal = vceqq_u8(chunk, vdupq_n_u8(static_cast<uint8_t>(delimiter)));
+        // narrow every byte to 4 bits (no movemask instruction on arm)
+        const auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x1111111111111111;
+    }
+#else
+    static constexpr std::size_t BLOCK_SIZE    = 0;
+    static constexpr std::size_t BITS_PER_CHAR = 1;
+
+    static uint64_t mask(const char *, char) { return 0; }
+#endif
+};
+
+/**
+ * @brief call a function for each field of a delimiter separated string
+ *
+ * @details
+ * The delimiters are searched block wise (see DelimiterBlock) in a single pass over the string.
+ * The fields are passed to the function as views of the string (no copy).
+ * A string without delimiter consists of one field, an empty string of one empty field.
+ *
+ * @param str delimiter separated string
+ * @param delimiter delimiter
+ * @param f function that is called for every field (bool f(std::string_view)). Return false to stop.
+ * @return false if the iteration was stopped by f
+ */
+template <typename F>
+static inline bool for_each_field(std::string_view str, char delimiter, F &&f) {
+    std::size_t start = 0;  // start of the current field
+    std::size_t pos   = 0;  // start of the current block
+
+    if constexpr (DelimiterBlock::BLOCK_SIZE > 0) {
+        for (; pos + DelimiterBlock::BLOCK_SIZE <= str.size(); pos += DelimiterBlock::BLOCK_SIZE) {
+            for (auto mask = DelimiterBlock::mask(str.data() + pos, delimiter); mask; mask &= mask - 1) {
+                const auto end = pos + static_cast<std::size_t>(std::countr_zero(mask)) / DelimiterBlock::BITS_PER_CHAR;
+                if (!f(str.substr(start, end - start))) return false;
+                start = end + 1;
+            }
+        }
+    }
+
+    // remaining characters
+    for (; pos < str.size(); ++pos) {
+        if (str[pos] != delimiter) continue;
+        if (!f(str.substr(start, pos - start))) return false;
+        start = pos + 1;
+    }
+
+    return f(str.substr(start));
+}
+
+}  // namespace InputParser
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "to_timespec.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <poll.h>
+#include <string_view>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief buffered line reader for non-interactive input
+ *
+ * @details
+ * Reads large chunks of data with read(2) into a reusable buffer and returns the lines as string views into this
+ * buffer. The lines are not copied.
+ *
+ * A returned line stays valid until fill() is called while fill_invalidates_lines() is true.
+ * Reading more data into the free space at the end of the buffer does not invalidate returned lines.
+ */
+class LineReader {
+public:
+    //* default size of the buffer
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    //* minimum free space at the end of the buffer that is used for a read call without reorganizing the buffer
+    static constexpr std::size_t MIN_READ_SIZE = 64 * 1024;
+
+private:
+    int               fd;
+    std::vector<char> buffer;
+    std::size_t       begin = 0;  // start of the data that was not yet returned
+    std::size_t       end   = 0;  // end of the valid data
+    bool              eof   = false;
+
+public:
+    /**
+     * @brief create line reader
+     * @param fd file descriptor to read from
+     * @param buffer_size initial buffer size (grows if a line does not fit into the buffer)
+     */
+    explicit LineReader(int fd, std::size_t buffer_size = DEFAULT_BUFFER_SIZE)
+        : fd(fd), buffer(std::max(buffer_size, 2 * MIN_READ_SIZE)) {}
+
+    /**
+     * @brief get the next line from the buffer (without newline character)
+     *
+     * @details
+     * Does not read any data. If the end of the input was reached, the last line is returned even if it is not
+     * terminated by a newline character.
+     *
+     * @param line receives the line
+     * @return true if a line was returned, false if the buffer contains no complete line
+     */
+    bool get_line(std::string_view &line) {
+        const char *data = buffer.data() + begin;
+        const auto  size = end - begin;
+
+        const auto *newline = static_cast<const char *>(std::memchr(data, '\n', size));
+        if (newline) {
+            const auto length = static_cast<std::size_t>(newline - data);
+            line              = std::string_view(data, length);
+            begin += length + 1;
+            return true;
+        }
+
+        if (eof && size) {
+            line  = std::string_view(data, size);
+            begin = end;
+            return true;
+        }
+
+        return false;
+    }
+
+    //* true if the end of the input was reached
+    [[nodiscard]] bool is_eof() const { return eof; }
+
+    //* true if the next call of fill() invalidates the lines that were returned by get_line()
+    [[nodiscard]] bool fill_invalidates_lines() const { return buffer.size() - end < MIN_READ_SIZE; }
+
+    /**
+     * @brief read data into the buffer (single read call)
+     *
+     * @details
+     * Blocks until data is available. If there is not enough free space at the end of the buffer, the buffer is
+     * reorganized (see fill_invalidates_lines()).
+     *
+     * @return false if the end of the input was reached
+     *
+     * @exception std::system_error thrown if read fails
+     */
+    bool fill() {
+        if (eof) return false;
+
+        if (fill_invalidates_lines()) {
+            const auto size = end - begin;
+            std::memmove(buffer.data(), buffer.data() + begin, size);
+            begin = 0;
+            end   = size;
+            if (buffer.size() - end < MIN_READ_SIZE) buffer.resize(buffer.size() * 2);
+        }
+
+        while (true) {
+            const auto n = read(fd, buffer.data() + end, buffer.size() - end);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "read failed");
+            }
+
+            if (n == 0) {
+                eof = true;
+                return false;
+            }
+
+            end += static_cast<std::size_t>(n);
+            return true;
+        }
+    }
+
+    /**
+     * @brief wait until data can be read or the deadline is reached
+     * @param deadline deadline
+     * @return true if data can be read (or the end of the input was reached)
+     */
+    [[nodiscard]] bool wait(const std::chrono::steady_clock::time_point &deadline) const {
+        const auto remaining = std::max(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()),
+                std::chrono::nanoseconds(0));
+
+        const timespec timeout = to_timespec(remaining);
+
+        pollfd pfd {fd, POLLIN, 0};
+        return ppoll(&pfd, 1, &timeout, nullptr) > 0;
+    }
+};
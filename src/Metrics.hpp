@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "Histogram.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+/**
+ * @brief counters and histograms of the application (see --metrics-json, --metrics-shm, --metrics-socket)
+ *
+ * @details
+ * The metrics are not thread safe. They are only modified and copied while the output mutex is locked.
+ */
+struct Metrics {
+    //* names of the register types (index: register type)
+    static constexpr std::array<std::string_view, 4> REGISTER_TYPE_NAMES = {"do", "di", "ao", "ai"};
+
+    uint64_t                lines_read             = 0;
+    uint64_t                lines_parsed           = 0;
+    uint64_t                discarded_parse_error  = 0;
+    uint64_t                discarded_unknown_type = 0;
+    uint64_t                discarded_out_of_range = 0;
+    std::array<uint64_t, 4> registers_written {};
+    uint64_t                semaphore_timeouts = 0;
+
+    Histogram parse_time_ns;      // time to parse an input line
+    Histogram semaphore_wait_us;  // time to acquire the semaphore
+    Histogram semaphore_hold_us;  // time the semaphore was held
+    Histogram latency_us;         // time from reading an input line until it is written to the shared memory
+
+    /**
+     * @brief write metrics as single line JSON object
+     * @param o output stream
+     */
+    void write_json(std::ostream &o) const {
+        auto histogram = [&o](std::string_view name, const Histogram &h) {
+            o << ",\"" << name << "\":{\"count\":" << h.get_count() << ",\"sum\":" << h.get_sum()
+              << ",\"max\":" << h.get_max() << ",\"buckets\":[";
+            bool first = true;
+            for (std::size_t i = 0; i < Histogram::BUCKETS; ++i) {
+                if (!h.get_bucket(i)) continue;
+                if (!first) o << ',';
+                first = false;
+                o << '[' << Histogram::upper_bound(i) << ',' << h.get_bucket(i) << ']';
+            }
+            o << "]}";
+        };
+
+        o << "{\"lines_read\":" << lines_read << ",\"lines_parsed\":" << lines_parsed
+          << ",\"discarded\":{\"parse_error\":" << discarded_parse_error
+          << ",\"unknown_type\":" << discarded_unknown_type << ",\"out_of_range\":" << discarded_out_of_range
+          << "},\"registers_written\":{";
+        for (std::size_t i = 0; i < registers_written.size(); ++i) {
+            if (i) o << ',';
+            o << '"' << REGISTER_TYPE_NAMES[i] << "\":" << registers_written[i];
+        }
+        o << "},\"semaphore_timeouts\":" << semaphore_timeouts;
+        histogram("parse_time_ns", parse_time_ns);
+        histogram("semaphore_wait_us", semaphore_wait_us);
+        histogram("semaphore_hold_us", semaphore_hold_us);
+        histogram("latency_us", latency_us);
+        o << '}';
+    }
+
+    /**
+     * @brief write metrics in the Prometheus text format
+     * @param o output stream
+     * @param prefix prefix of the metric names
+     */
+    void write_prometheus(std::ostream &o, std::string_view prefix) const {
+        auto counter = [&](std::string_view name, std::string_view help) {
+            o << "# HELP " << prefix << name << ' ' << help << '\n';
+            o << "# TYPE " << prefix << name << " counter\n";
+        };
+
+        // the histogram values are converted to seconds (base unit)
+        auto histogram = [&](std::string_view name, const Histogram &h, double unit, std::string_view help) {
+            o << "# HELP " << prefix << name << ' ' << help << '\n';
+            o << "# TYPE " << prefix << name << " histogram\n";
+            uint64_t cumulative = 0;
+            for (std::size_t i = 0; i < Histogram::BUCKETS - 1; ++i) {
+                cumulative += h.get_bucket(i);
+                o << prefix << name << "_bucket{le=\"" << static_cast<double>(Histogram::upper_bound(i)) * unit
+                  << "\"} " << cumulative << '\n';
+            }
+            o << prefix << name << "_bucket{le=\"+Inf\"} " << h.get_count() << '\n';
+            o << prefix << name << "_sum " << static_cast<double>(h.get_sum()) * unit << '\n';
+            o << prefix << name << "_count " << h.get_count() << '\n';
+        };
+
+        counter("lines_read_total", "Number of input lines.");
+        o << prefix << "lines_read_total " << lines_read << '\n';
+        counter("lines_parsed_total", "Number of valid input lines.");
+        o << prefix << "lines_parsed_total " << lines_parsed << '\n';
+
+        counter("lines_discarded_total", "Number of discarded input lines.");
+        o << prefix << "lines_discarded_total{reason=\"parse_error\"} " << discarded_parse_error << '\n';
+        o << prefix << "lines_discarded_total{reason=\"unknown_type\"} " << discarded_unknown_type << '\n';
+        o << prefix << "lines_discarded_total{reason=\"out_of_range\"} " << discarded_out_of_range << '\n';
+
+        counter("registers_written_total", "Number of register writes.");
+        for (std::size_t i = 0; i < registers_written.size(); ++i)
+            o << prefix << "registers_written_total{type=\"" << REGISTER_TYPE_NAMES[i] << "\"} "
+              << registers_written[i] << '\n';
+
+        counter("semaphore_timeouts_total", "Number of failed semaphore acquisitions.");
+        o << prefix << "semaphore_timeouts_total " << semaphore_timeouts << '\n';
+
+        histogram("parse_time_seconds", parse_time_ns, 1e-9, "Time to parse an input line.");
+        histogram("semaphore_wait_seconds", semaphore_wait_us, 1e-6, "Time to acquire the semaphore.");
+        histogram("semaphore_hold_seconds", semaphore_hold_us, 1e-6, "Time the semaphore was held.");
+        histogram("latency_seconds", latency_us, 1e-6, "Time from reading an input line to the shared memory write.");
+    }
+};
+
+/**
+ * @brief layout of the metrics shared memory (see --metrics-shm)
+ *
+ * @details
+ * The segment is written periodically. Readers have to use the sequence number (seqlock): it is odd while the
+ * segment is updated. A consistent copy was read if the sequence number is even and did not change during the copy.
+ */
+struct MetricsShm {
+    //* identifies the layout ("MSTA")
+    static constexpr uint32_t MAGIC = 0x4D535441;
+
+    //* layout version
+    static constexpr uint32_t VERSION = 1;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    uint32_t              magic   = MAGIC;
+    uint32_t              version = VERSION;
+    std::atomic<uint64_t> sequence {0};
+
+    uint64_t                                 lines_read {};
+    uint64_t                                 lines_parsed {};
+    uint64_t                                 discarded_parse_error {};
+    uint64_t                                 discarded_unknown_type {};
+    uint64_t                                 discarded_out_of_range {};
+    std::array<uint64_t, 4>                  registers_written {};
+    uint64_t                                 semaphore_timeouts {};
+    std::array<uint64_t, Histogram::BUCKETS> parse_time_ns {};
+    std::array<uint64_t, Histogram::BUCKETS> semaphore_wait_us {};
+    std::array<uint64_t, Histogram::BUCKETS> semaphore_hold_us {};
+    std::array<uint64_t, Histogram::BUCKETS> latency_us {};
+
+    /**
+     * @brief update the segment (single writer)
+     * @param metrics current metrics
+     */
+    void store(const Metrics &metrics) {
+        auto buckets = [](std::array<uint64_t, Histogram::BUCKETS> &dst, const Histogram &h) {
+            for (std::size_t i = 0; i < Histogram::BUCKETS; ++i)
+                dst[i] = h.get_bucket(i);
+        };
+
+        const auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        lines_read             = metrics.lines_read;
+        lines_parsed           = metrics.lines_parsed;
+        discarded_parse_error  = metrics.discarded_parse_error;
+        discarded_unknown_type = metrics.discarded_unknown_type;
+        discarded_out_of_range = metrics.discarded_out_of_range;
+        registers_written      = metrics.registers_written;
+        semaphore_timeouts     = metrics.semaphore_timeouts;
+        buckets(parse_time_ns, metrics.parse_time_ns);
+        buckets(semaphore_wait_us, metrics.semaphore_wait_us);
+        buckets(semaphore_hold_us, metrics.semaphore_hold_us);
+        buckets(latency_us, metrics.latency_us);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+};
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <streambuf>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief fully buffered output stream buffer for a file descriptor
+ *
+ * @details
+ * Data is only written (write(2)) if the buffer is full or the stream is flushed.
+ * Can be used to replace the stream buffer of std::cout and std::cerr to avoid one write call per output line.
+ *
+ * The buffer is not thread safe.
+ */
+class OutputBuffer : public std::streambuf {
+public:
+    //* default size of the buffer
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+private:
+    int               fd;
+    std::vector<char> buffer;
+
+    /**
+     * @brief write all buffered data
+     * @return true on success
+     */
+    bool write_buffer() {
+        const char *data = pbase();
+        auto        size = static_cast<std::size_t>(pptr() - pbase());
+
+        while (size) {
+            const auto n = write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return size == 0;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!write_buffer()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return write_buffer() ? 0 : -1; }
+
+public:
+    /**
+     * @brief create output buffer
+     * @param fd file descriptor to write to
+     * @param buffer_size size of the buffer
+     */
+    explicit OutputBuffer(int fd, std::size_t buffer_size = DEFAULT_BUFFER_SIZE) : fd(fd), buffer(buffer_size) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    OutputBuffer(const OutputBuffer &)            = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    ~OutputBuffer() override { write_buffer(); }
+};
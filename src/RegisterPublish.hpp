@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief find a run of contiguous registers (value of a 32 or 64 bit data type or a value list)
+ *
+ * @details
+ * The instructions are a run if there are at least 2 instructions of the same analog register type (AO or AI) with
+ * consecutive ascending addresses.
+ *
+ * @param instructions instructions of an input line
+ * @param values receives the register values (in address order)
+ * @return number of registers of the run (0: the instructions are no run)
+ */
+static inline std::size_t register_run(const InputParser::Instructions                              &instructions,
+                                       std::array<uint16_t, InputParser::Instructions::CAPACITY> &values) {
+    if (instructions.size() < 2) return 0;
+
+    const auto &first = instructions[0];
+    if (first.register_type != InputParser::Instruction::register_type_t::AO &&
+        first.register_type != InputParser::Instruction::register_type_t::AI)
+        return 0;
+
+    for (std::size_t i = 0; i < instructions.size(); ++i) {
+        const auto &instruction = instructions[i];
+        if (instruction.register_type != first.register_type || instruction.address != first.address + i) return 0;
+        values[i] = instruction.value;
+    }
+
+    return instructions.size();
+}
+
+/**
+ * @brief write contiguous registers with as few stores as possible
+ *
+ * @details
+ * 2 registers at an address that is aligned to 4 bytes and 4 registers at an address that is aligned to 8 bytes are
+ * written with a single atomic store. A reader that loads the value with the same alignment and width can not see a
+ * torn value. All other runs are copied (not atomic, see RegisterSeqlock).
+ *
+ * @param dst address of the first register in the shared memory
+ * @param values register values
+ * @param count number of registers
+ * @return true if the registers were written with a single atomic store
+ */
+static inline bool publish_registers(uint16_t *dst, const uint16_t *values, std::size_t count) {
+    const auto alignment = reinterpret_cast<std::uintptr_t>(dst);  // NOLINT
+
+    if (count == 2 && alignment % sizeof(uint32_t) == 0) {
+        uint32_t value {};
+        std::memcpy(&value, values, sizeof(value));
+        auto *word = reinterpret_cast<uint32_t *>(dst);  // NOLINT
+        std::atomic_ref<uint32_t>(*word).store(value, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (count == 4 && alignment % sizeof(uint64_t) == 0) {
+        uint64_t value {};
+        std::memcpy(&value, values, sizeof(value));
+        auto *word = reinterpret_cast<uint64_t *>(dst);  // NOLINT
+        std::atomic_ref<uint64_t>(*word).store(value, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::memcpy(dst, values, count * sizeof(uint16_t));
+    return false;
+}
+
+/**
+ * @brief layout of the seqlock shared memory (see --seqlock)
+ *
+ * @details
+ * There is one sequence number per register type (index: register type), each in a separate cache line.
+ * The sequence number is odd while registers of the type are written.
+ * A reader that copies registers and reads the same even sequence number before and after the copy has read
+ * a consistent state (without the semaphore).
+ */
+struct RegisterSeqlock {
+    //* identifies the layout ("MSQL")
+    static constexpr uint32_t MAGIC = 0x4D53514C;
+
+    //* layout version
+    static constexpr uint32_t VERSION = 1;
+
+    //* size of a cache line (false sharing of the sequence numbers)
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    //* sequence number of a register type
+    struct alignas(CACHE_LINE) sequence_t {
+        std::atomic<uint64_t> value {0};
+    };
+
+    uint32_t                  magic   = MAGIC;
+    uint32_t                  version = VERSION;
+    std::array<sequence_t, 4> sequences {};
+
+    /**
+     * @brief start writing registers of a type (single writer)
+     * @param type register type
+     */
+    void begin(InputParser::Instruction::register_type_t type) {
+        auto      &sequence = sequences[static_cast<std::size_t>(type)].value;
+        const auto seq      = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief finish writing registers of a type (single writer)
+     * @param type register type
+     */
+    void end(InputParser::Instruction::register_type_t type) {
+        auto &sequence = sequences[static_cast<std::size_t>(type)].value;
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief local copy of the register values that were written to the shared memory (see --skip-unchanged)
+ *
+ * @details
+ * Used to skip writes of values that the registers already contain. Changes of the shared memory by other processes
+ * (e.g. the Modbus client) are not visible in the shadow image.
+ */
+class RegisterShadow {
+private:
+    static constexpr std::size_t REGISTER_TYPES = 4;
+
+    std::array<std::vector<uint16_t>, REGISTER_TYPES> values;
+
+public:
+    /**
+     * @brief create shadow image
+     * @param elements number of registers per register type (DO, DI, AO, AI)
+     */
+    explicit RegisterShadow(const std::array<std::size_t, REGISTER_TYPES> &elements) {
+        for (std::size_t i = 0; i < REGISTER_TYPES; ++i)
+            values[i].resize(elements[i]);
+    }
+
+    /**
+     * @brief load the current content of a coil shared memory (DO, DI)
+     * @param type register type
+     * @param coils shared memory (one byte per coil)
+     */
+    void load(InputParser::Instruction::register_type_t type, const uint8_t *coils) {
+        auto &reg = values[static_cast<std::size_t>(type)];
+        std::transform(coils, coils + reg.size(), reg.begin(), [](uint8_t coil) -> uint16_t { return coil ? 1 : 0; });
+    }
+
+    /**
+     * @brief load the current content of a register shared memory (AO, AI)
+     * @param type register type
+     * @param registers shared memory
+     */
+    void load(InputParser::Instruction::register_type_t type, const uint16_t *registers) {
+        auto &reg = values[static_cast<std::size_t>(type)];
+        std::copy_n(registers, reg.size(), reg.begin());
+    }
+
+    /**
+     * @brief store value of a register
+     * @param type register type
+     * @param address register address (has to be in range)
+     * @param value register value (0 or 1 for coils)
+     * @return false if the register already contains the value
+     */
+    bool update(InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+        auto &reg = values[static_cast<std::size_t>(type)][address];
+        if (reg == value) return false;
+        reg = value;
+        return true;
+    }
+};
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "to_timespec.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+/**
+ * @brief replay of recorded scenario files (see --replay)
+ *
+ * @details
+ * A scenario file contains instruction lines and timing lines:
+ *   - @<microseconds>  absolute time (relative to the start of the recording) of the following instructions
+ *                      (written by --passthrough --timestamps)
+ *   - sleep <seconds>  relative delay (written by --passthrough --bash)
+ *   - echo '<line>'    instruction line (written by --passthrough --bash)
+ */
+namespace Replay {
+
+//* prefix of timestamp lines
+static constexpr char TIMESTAMP_PREFIX = '@';
+
+//* prefix of bash sleep lines
+static constexpr std::string_view SLEEP_PREFIX = "sleep ";
+
+//* prefix of bash echo lines
+static constexpr std::string_view ECHO_PREFIX = "echo '";
+
+/**
+ * @brief read only memory mapping of a file
+ *
+ * @details
+ * The file is not loaded into memory. The kernel reads the pages on demand (sequential access is advised).
+ */
+class MappedFile {
+private:
+    void       *addr = nullptr;
+    std::size_t size = 0;
+
+public:
+    /**
+     * @brief map file
+     * @param path file path
+     *
+     * @exception std::system_error thrown if the file can not be opened or mapped
+     */
+    explicit MappedFile(const std::string &path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "failed to open '" + path + '\'');
+
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat)) {
+            const int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "failed to stat '" + path + '\'');
+        }
+
+        size = static_cast<std::size_t>(file_stat.st_size);
+        if (size) {
+            addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {  // NOLINT
+                const int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "failed to map '" + path + '\'');
+            }
+            madvise(addr, size, MADV_SEQUENTIAL);
+        }
+
+        close(fd);
+    }
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        if (addr) munmap(addr, size);
+    }
+
+    //* file content
+    [[nodiscard]] std::string_view data() const { return {static_cast<const char *>(addr), size}; }
+};
+
+/**
+ * @brief parse timestamp line
+ * @param line input line
+ * @param timestamp_us receives the timestamp in microseconds
+ * @return true if the line is a valid timestamp line
+ */
+static bool parse_timestamp(std::string_view line, int64_t &timestamp_us) {
+    if (line.empty() || line.front() != TIMESTAMP_PREFIX) return false;
+    const auto *first  = line.data() + 1;
+    const auto *last   = line.data() + line.size();
+    const auto  result = std::from_chars(first, last, timestamp_us);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+/**
+ * @brief parse bash sleep line
+ * @param line input line
+ * @param sleep_us receives the sleep time in microseconds
+ * @return true if the line is a valid sleep line
+ */
+static bool parse_sleep(std::string_view line, int64_t &sleep_us) {
+    if (line.substr(0, SLEEP_PREFIX.size()) != SLEEP_PREFIX) return false;
+    double      seconds {};
+    const auto *first  = line.data() + SLEEP_PREFIX.size();
+    const auto *last   = line.data() + line.size();
+    const auto  result = std::from_chars(first, last, seconds);
+    if (result.ec != std::errc() || result.ptr != last || seconds < 0) return false;
+    sleep_us = static_cast<int64_t>(seconds * 1'000'000.0);
+    return true;
+}
+
+/**
+ * @brief remove bash echo command
+ * @param line input line (echo '<instruction>')
+ * @return instruction (unmodified line if it is not an echo line)
+ */
+static std::string_view strip_echo(std::string_view line) {
+    if (line.size() > ECHO_PREFIX.size() && line.substr(0, ECHO_PREFIX.size()) == ECHO_PREFIX && line.back() == '\'')
+        return line.substr(ECHO_PREFIX.size(), line.size() - ECHO_PREFIX.size() - 1);
+    return line;
+}
+
+/**
+ * @brief sleep until the given time point (absolute, no drift)
+ * @param time_point time point to wait for
+ * @return false if the sleep was interrupted by a signal
+ */
+static bool sleep_until(const std::chrono::steady_clock::time_point &time_point) {
+    static_assert(std::chrono::steady_clock::is_steady);
+
+    const timespec ts = to_timespec(time_point.time_since_epoch());
+
+    // std::chrono::steady_clock is based on CLOCK_MONOTONIC
+    return clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == 0;
+}
+
+}  // namespace Replay
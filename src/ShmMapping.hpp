@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "cxxshm.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+
+/**
+ * @brief preparation of shared memory mappings for a deterministic write latency
+ * (see --prefault, --mlock and --hugepage)
+ *
+ * @details
+ * Without preparation, the first write to each page of a mapping causes a page fault (while the semaphore is held).
+ */
+namespace ShmMapping {
+
+/**
+ * @brief request transparent huge pages for the mapping (MADV_HUGEPAGE)
+ *
+ * @details
+ * Only effective if huge pages are enabled for shared memory (/sys/kernel/mm/transparent_hugepage/shmem_enabled).
+ *
+ * @param shm shared memory
+ * @return false if the kernel does not support huge pages for the mapping
+ */
+static inline bool advise_hugepage(const cxxshm::SharedMemory &shm) {
+    if (!shm.get_size()) return true;
+    return madvise(shm.get_addr<void *>(), shm.get_size(), MADV_HUGEPAGE) == 0;
+}
+
+/**
+ * @brief map all pages of the mapping writable without modifying their content
+ *
+ * @details
+ * Uses MADV_POPULATE_WRITE (Linux 5.14). On older kernels, every page is read instead. For shared memory, a read
+ * fault maps the page writable, too.
+ *
+ * @param shm shared memory
+ *
+ * @exception std::system_error thrown if the pages can not be populated
+ */
+static inline void prefault(const cxxshm::SharedMemory &shm) {
+    if (!shm.get_size()) return;
+
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(shm.get_addr<void *>(), shm.get_size(), MADV_POPULATE_WRITE) == 0) return;
+    if (errno != EINVAL) {
+        throw std::system_error(
+                errno, std::generic_category(), "Failed to prefault shared memory '" + shm.get_name() + '\'');
+    }
+#endif
+
+    const auto  page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const auto *data      = shm.get_addr<const volatile char *>();
+    for (std::size_t offset = 0; offset < shm.get_size(); offset += page_size)
+        static_cast<void>(data[offset]);
+}
+
+/**
+ * @brief lock the pages of the mapping in memory (mlock)
+ * @param shm shared memory
+ *
+ * @exception std::system_error thrown if the pages can not be locked (e.g. RLIMIT_MEMLOCK exceeded)
+ */
+static inline void lock(const cxxshm::SharedMemory &shm) {
+    if (!shm.get_size()) return;
+
+    if (mlock(shm.get_addr<const void *>(), shm.get_size())) {
+        throw std::system_error(
+                errno, std::generic_category(), "Failed to lock shared memory '" + shm.get_name() + "' in memory");
+    }
+}
+
+}  // namespace ShmMapping
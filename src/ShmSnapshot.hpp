@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
+/**
+ * @brief positions of the differing bytes of two blocks (SIMD)
+ *
+ * @details
+ * BLOCK_SIZE bytes are compared at once. Each byte is represented by BITS_PER_BYTE bits of the mask, exactly one of
+ * them (the lowest) is set if the bytes differ (see DelimiterBlock in InputParser_tokenize.hpp).
+ */
+struct DiffBlock {
+#if defined(__AVX2__)
+    static constexpr std::size_t BLOCK_SIZE    = 32;
+    static constexpr std::size_t BITS_PER_BYTE = 1;
+
+    static uint64_t mask(const uint8_t *a, const uint8_t *b) {
+        const auto chunk_a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));  // NOLINT
+        const auto chunk_b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));  // NOLINT
+        return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk_a, chunk_b)));
+    }
+#elif defined(__SSE2__)
+    static constexpr std::size_t BLOCK_SIZE    = 16;
+    static constexpr std::size_t BITS_PER_BYTE = 1;
+
+    static uint64_t mask(const uint8_t *a, const uint8_t *b) {
+        const auto chunk_a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));  // NOLINT
+        const auto chunk_b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));  // NOLINT
+        return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk_a, chunk_b))) & 0xFFFF;
+    }
+#elif defined(__ARM_NEON)
+    static constexpr std::size_t BLOCK_SIZE    = 16;
+    static constexpr std::size_t BITS_PER_BYTE = 4;
+
+    static uint64_t mask(const uint8_t *a, const uint8_t *b) {
+        const auto differ = vmvnq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b)));
+        // narrow every byte to 4 bits (no movemask instruction on arm)
+        const auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(differ), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x1111111111111111;
+    }
+#else
+    static constexpr std::size_t BLOCK_SIZE    = 8;
+    static constexpr std::size_t BITS_PER_BYTE = 1;
+
+    static uint64_t mask(const uint8_t *a, const uint8_t *b) {
+        uint64_t word_a {};
+        uint64_t word_b {};
+        std::memcpy(&word_a, a, sizeof(word_a));
+        std::memcpy(&word_b, b, sizeof(word_b));
+        if (word_a == word_b) return 0;
+
+        uint64_t mask = 0;
+        for (std::size_t i = 0; i < BLOCK_SIZE; ++i)
+            if (a[i] != b[i]) mask |= uint64_t(1) << i;
+        return mask;
+    }
+#endif
+};
+
+/**
+ * @brief shadow copy of a shared memory object that detects changed registers (see --monitor)
+ */
+class ShmSnapshot {
+private:
+    std::vector<uint8_t> shadow;
+    std::size_t          element_size;
+
+public:
+    /**
+     * @brief create snapshot (copy of the current content)
+     * @param live address of the shared memory
+     * @param size size of the shared memory in bytes (multiple of element_size)
+     * @param element_size size of a register (1: coils, 2: analog registers)
+     */
+    ShmSnapshot(const void *live, std::size_t size, std::size_t element_size)
+        : shadow(static_cast<const uint8_t *>(live), static_cast<const uint8_t *>(live) + size),
+          element_size(element_size) {}
+
+    /**
+     * @brief compare the shared memory to the snapshot and update the snapshot
+     *
+     * @details
+     * The shared memory is compared block wise (see DiffBlock). Only the changed registers are copied.
+     *
+     * @param live address of the shared memory
+     * @param changed function that is called with the index of every changed register (in address order)
+     */
+    template <typename F>
+    void update(const void *live, F &&changed) {
+        const auto *src  = static_cast<const uint8_t *>(live);
+        auto       *dst  = shadow.data();
+        const auto  size = shadow.size();
+
+        std::size_t last = SIZE_MAX;  // last reported register (both bytes of a register can differ)
+        auto        copy = [&](std::size_t offset) {
+            const auto index = offset / element_size;
+            if (index == last) return;
+            last = index;
+            std::memcpy(dst + index * element_size, src + index * element_size, element_size);
+            changed(index);
+        };
+
+        static_assert(DiffBlock::BLOCK_SIZE % sizeof(uint16_t) == 0);  // registers do not cross block boundaries
+        std::size_t pos = 0;
+        for (; pos + DiffBlock::BLOCK_SIZE <= size; pos += DiffBlock::BLOCK_SIZE) {
+            for (auto mask = DiffBlock::mask(src + pos, dst + pos); mask; mask &= mask - 1)
+                copy(pos + static_cast<std::size_t>(std::countr_zero(mask)) / DiffBlock::BITS_PER_BYTE);
+        }
+
+        // remaining bytes
+        for (; pos < size; ++pos)
+            if (src[pos] != dst[pos]) copy(pos);
+    }
+
+    //* value of a register (converted from the shadow copy)
+    [[nodiscard]] uint16_t value(std::size_t index) const {
+        if (element_size == sizeof(uint8_t)) return shadow[index];
+
+        uint16_t value {};
+        std::memcpy(&value, shadow.data() + index * sizeof(uint16_t), sizeof(value));
+        return value;
+    }
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+
+#include "cxxsemaphore.hpp"
+#include "cxxshm.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief additional Modbus shared memory (see --target)
+ *
+ * @details
+ * Consists of the four shared memory objects (DO, DI, AO, AI) of a name prefix and an optional semaphore.
+ * Input lines are routed to the target by the prefix 'NAME/'.
+ */
+class ShmTarget {
+public:
+    //* maximum number of registers per register type
+    static constexpr std::size_t MAX_MODBUS_REGS = 0x10000;
+
+private:
+    static constexpr std::size_t REGISTER_TYPES = 4;
+
+    std::string                                                       name;
+    std::array<std::unique_ptr<cxxshm::SharedMemory>, REGISTER_TYPES> shm;
+    std::array<std::size_t, REGISTER_TYPES>                           elements {};
+    std::unique_ptr<cxxsemaphore::Semaphore>                          semaphore;
+
+public:
+    /**
+     * @brief open the shared memory and the semaphore of a target
+     * @param definition target definition: NAME=PREFIX[:SEMAPHORE]
+     *
+     * @exception std::invalid_argument thrown if the definition is not valid
+     * @exception std::system_error thrown if a shared memory object can not be opened
+     * @exception std::runtime_error thrown if a shared memory object is not a valid Modbus shared memory or the
+     *                               semaphore can not be opened
+     */
+    explicit ShmTarget(const std::string &definition) {
+        static constexpr std::array<const char *, REGISTER_TYPES> SUFFIXES = {"DO", "DI", "AO", "AI"};
+
+        const auto equal = definition.find('=');
+        if (equal == std::string::npos || equal == 0 || equal + 1 == definition.size())
+            throw std::invalid_argument("invalid target '" + definition + "' (expected NAME=PREFIX[:SEMAPHORE])");
+
+        name = definition.substr(0, equal);
+        if (name.find_first_of("/:") != std::string::npos)
+            throw std::invalid_argument("invalid target name '" + name + "' ('/' and ':' are not allowed)");
+
+        const auto colon  = definition.find(':', equal);
+        const auto prefix = definition.substr(equal + 1, colon == std::string::npos ? colon : colon - equal - 1);
+
+        for (std::size_t i = 0; i < REGISTER_TYPES; ++i) {
+            shm[i] = std::make_unique<cxxshm::SharedMemory>(prefix + SUFFIXES[i]);
+
+            const bool coil = i < 2;
+            if (!coil && shm[i]->get_size() % 2) {
+                throw std::runtime_error("the size of shared memory '" + shm[i]->get_name() +
+                                         "' is odd. It is not a valid Modbus shm.");
+            }
+
+            elements[i] = coil ? shm[i]->get_size() : shm[i]->get_size() / 2;
+            if (elements[i] > MAX_MODBUS_REGS) {
+                throw std::runtime_error("shared memory '" + shm[i]->get_name() +
+                                         "' is to large to be a valid Modbus shared memory.");
+            }
+        }
+
+        if (colon != std::string::npos)
+            semaphore = std::make_unique<cxxsemaphore::Semaphore>(definition.substr(colon + 1));
+    }
+
+    //* name of the target (line prefix 'NAME/')
+    [[nodiscard]] const std::string &get_name() const { return name; }
+
+    //* semaphore of the target (nullptr if the target has no semaphore)
+    [[nodiscard]] cxxsemaphore::Semaphore *get_semaphore() const { return semaphore.get(); }
+
+    //* number of registers of the given type
+    [[nodiscard]] std::size_t register_count(InputParser::Instruction::register_type_t type) const {
+        return elements[static_cast<std::size_t>(type)];
+    }
+
+    /**
+     * @brief write a single register
+     * @param type register type
+     * @param address register address (has to be in range)
+     * @param value register value (0 or 1 for coils)
+     */
+    void write(InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+        const auto index = static_cast<std::size_t>(type);
+        switch (type) {
+            case InputParser::Instruction::register_type_t::DO:
+            case InputParser::Instruction::register_type_t::DI:
+                shm[index]->get_addr<uint8_t *>()[address] = static_cast<uint8_t>(value);
+                break;
+            case InputParser::Instruction::register_type_t::AO:
+            case InputParser::Instruction::register_type_t::AI:
+                shm[index]->get_addr<uint16_t *>()[address] = value;
+                break;
+        }
+    }
+};
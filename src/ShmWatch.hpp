@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <string>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief watches the files of POSIX shared memory objects and semaphores (see --reattach)
+ *
+ * @details
+ * Uses inotify on the directory /dev/shm. No polling is required: the file descriptor (get_fd()) becomes readable
+ * if one of the watched files is created, removed, renamed or resized.
+ */
+class ShmWatch {
+public:
+    //* directory that contains the POSIX shared memory objects and named semaphores
+    static constexpr const char *SHM_DIR = "/dev/shm";
+
+    //* events of the watched files
+    struct events_t {
+        bool removed = false;  // at least one watched file was removed (or renamed)
+        bool changed = false;  // at least one watched file was created or modified
+    };
+
+private:
+    int                      fd;
+    std::vector<std::string> files;  // file names in SHM_DIR
+
+public:
+    /**
+     * @brief start watching
+     * @param files names of the files in SHM_DIR (see shm_file() and semaphore_file())
+     *
+     * @exception std::system_error thrown if the inotify watch can not be established
+     */
+    explicit ShmWatch(std::vector<std::string> files) : files(std::move(files)) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "inotify_init1 failed");
+
+        static constexpr uint32_t MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY;
+        if (inotify_add_watch(fd, SHM_DIR, MASK) < 0) {
+            const int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), std::string("failed to watch ") + SHM_DIR);
+        }
+    }
+
+    ShmWatch(const ShmWatch &)            = delete;
+    ShmWatch &operator=(const ShmWatch &) = delete;
+
+    ~ShmWatch() { close(fd); }
+
+    //* inotify file descriptor (readable if events are available)
+    [[nodiscard]] int get_fd() const { return fd; }
+
+    /**
+     * @brief read all available events (does not block)
+     * @return events of the watched files
+     */
+    events_t read_events() {
+        events_t events;
+
+        alignas(inotify_event) std::array<char, 4096> buffer {};
+        while (true) {
+            const auto n = read(fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                break;  // no more events (EAGAIN)
+            }
+
+            for (const char *ptr = buffer.data(); ptr < buffer.data() + n;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(ptr);  // NOLINT
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (!event->len || std::find(files.begin(), files.end(), event->name) == files.end()) continue;
+
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM)) events.removed = true;
+                else
+                    events.changed = true;
+            }
+        }
+
+        return events;
+    }
+
+    /**
+     * @brief file name of a shared memory object
+     * @param name name of the shared memory object
+     * @return file name in SHM_DIR
+     */
+    static std::string shm_file(const std::string &name) { return name.starts_with('/') ? name.substr(1) : name; }
+
+    /**
+     * @brief file name of a named semaphore
+     * @param name name of the semaphore
+     * @return file name in SHM_DIR
+     */
+    static std::string semaphore_file(const std::string &name) { return "sem." + shm_file(name); }
+
+    /**
+     * @brief inode number of a file
+     * @param file file name in SHM_DIR
+     * @return inode number (0 if the file does not exist)
+     */
+    static ino_t inode(const std::string &file) {
+        struct stat file_stat {};
+        if (stat((std::string(SHM_DIR) + '/' + file).c_str(), &file_stat)) return 0;
+        return file_stat.st_ino;
+    }
+};
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief lock free single producer single consumer ring queue
+ *
+ * @details
+ * push() and pop() block if the queue is full/empty. Blocking uses std::atomic::wait (futex based, no busy waiting).
+ *
+ * @tparam T element type
+ * @tparam CAPACITY maximum number of elements (power of 2)
+ */
+template <typename T, std::size_t CAPACITY>
+class SpscQueue {
+    static_assert(std::has_single_bit(CAPACITY), "capacity must be a power of 2");
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::size_t MASK            = CAPACITY - 1;
+
+    std::array<T, CAPACITY> buffer {};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head {0};  // next element to pop (written by consumer)
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail {0};  // next free element (written by producer)
+
+public:
+    /**
+     * @brief append element (producer only). Blocks while the queue is full.
+     * @param value element
+     */
+    void push(T value) {
+        const auto t = tail.load(std::memory_order_relaxed);
+        while (true) {
+            const auto h = head.load(std::memory_order_acquire);
+            if (t - h < CAPACITY) break;
+            head.wait(h, std::memory_order_acquire);
+        }
+
+        buffer[t & MASK] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        tail.notify_one();
+    }
+
+    /**
+     * @brief remove element (consumer only) without blocking
+     * @param value receives the element
+     * @return false if the queue is empty
+     */
+    bool try_pop(T &value) {
+        const auto h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h) return false;
+
+        value = std::move(buffer[h & MASK]);
+        head.store(h + 1, std::memory_order_release);
+        head.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief remove element (consumer only). Blocks while the queue is empty.
+     * @return element
+     */
+    T pop() {
+        const auto h = head.load(std::memory_order_relaxed);
+        while (true) {
+            const auto t = tail.load(std::memory_order_acquire);
+            if (t != h) break;
+            tail.wait(t, std::memory_order_acquire);
+        }
+
+        T value = std::move(buffer[h & MASK]);
+        head.store(h + 1, std::memory_order_release);
+        head.notify_one();
+        return value;
+    }
+};
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser_string.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief compile time perfect hash map with case insensitive string keys
+ *
+ * @details
+ * The hash seed is searched at compile time until all keys are mapped to distinct slots.
+ * A lookup therefore needs exactly one hash calculation, one probe and one string comparison.
+ * No memory is allocated.
+ *
+ * All keys have to be lower case and unique. Otherwise the construction fails (compile time error if constexpr).
+ *
+ * @tparam T value type
+ * @tparam N number of entries
+ */
+template <typename T, std::size_t N>
+class StringMap {
+public:
+    using entry_t = std::pair<std::string_view, T>;
+
+private:
+    static_assert(N > 0, "empty map");
+    static_assert(N < UINT16_MAX, "too many entries");
+
+    //* minimum number of slots
+    static constexpr std::size_t MIN_SLOTS = 8;
+
+    //* number of slots (power of 2, large enough to find a collision free seed quickly)
+    static constexpr std::size_t SLOTS = std::bit_ceil(std::max(MIN_SLOTS, N * N / 8));
+
+    //* maximum number of seeds that are tried
+    static constexpr uint32_t MAX_SEEDS = 100'000;
+
+    //* marks an unused slot
+    static constexpr uint16_t EMPTY = UINT16_MAX;
+
+    // hash constants
+    static constexpr uint32_t FNV_OFFSET = 2166136261U;
+    static constexpr uint32_t FNV_PRIME  = 16777619U;
+    static constexpr int      MIX_SHIFT  = 15;
+
+    std::array<entry_t, N>      entries {};
+    std::array<uint16_t, SLOTS> slots {};
+    uint32_t                    seed = 0;
+
+    /**
+     * @brief case insensitive hash (FNV-1a)
+     * @param key key to hash
+     * @param hash_seed hash seed
+     * @return slot index
+     */
+    static constexpr std::size_t hash(std::string_view key, uint32_t hash_seed) {
+        uint32_t h = FNV_OFFSET ^ hash_seed;
+        for (const char c : key) {
+            h ^= static_cast<uint8_t>(InputParser::to_lower(c));
+            h *= FNV_PRIME;
+        }
+        h ^= h >> MIX_SHIFT;
+        return static_cast<std::size_t>(h) & (SLOTS - 1);
+    }
+
+public:
+    /**
+     * @brief create map
+     * @param init (key, value) pairs
+     *
+     * @exception std::invalid_argument thrown if a key is not lower case or not unique
+     * @exception std::runtime_error thrown if no collision free hash seed was found
+     */
+    constexpr explicit StringMap(const std::array<entry_t, N> &init) : entries(init) {
+        for (std::size_t i = 0; i < N; ++i) {
+            for (const char c : entries[i].first)
+                if (InputParser::to_lower(c) != c) throw std::invalid_argument("key not lower case");
+            for (std::size_t k = i + 1; k < N; ++k)
+                if (entries[i].first == entries[k].first) throw std::invalid_argument("duplicate key");
+        }
+
+        for (seed = 0; seed < MAX_SEEDS; ++seed) {
+            slots.fill(EMPTY);
+
+            bool collision = false;
+            for (std::size_t i = 0; i < N && !collision; ++i) {
+                auto &slot = slots[hash(entries[i].first, seed)];
+                collision  = slot != EMPTY;
+                slot       = static_cast<uint16_t>(i);
+            }
+
+            if (!collision) return;
+        }
+
+        throw std::runtime_error("no perfect hash seed found");
+    }
+
+    /**
+     * @brief lookup key (case insensitive)
+     * @param key key to search
+     * @return pointer to the value or nullptr if the key is unknown
+     */
+    [[nodiscard]] constexpr const T *find(std::string_view key) const {
+        const auto index = slots[hash(key, seed)];
+        if (index == EMPTY) return nullptr;
+
+        const auto &entry = entries[index];
+        return InputParser::iequals(key, entry.first) ? &entry.second : nullptr;
+    }
+
+    /**
+     * @brief check if the map contains a key (case insensitive)
+     * @param key key to search
+     * @return true if the key is known
+     */
+    [[nodiscard]] constexpr bool contains(std::string_view key) const { return find(key) != nullptr; }
+
+    //* number of entries
+    [[nodiscard]] static constexpr std::size_t size() { return N; }
+
+    [[nodiscard]] constexpr const entry_t *begin() const { return entries.data(); }
+    [[nodiscard]] constexpr const entry_t *end() const { return entries.data() + N; }
+};
+
+/**
+ * @brief create a StringMap (deduces the number of entries)
+ * @param init (key, value) pairs
+ * @return map
+ */
+template <typename T, std::size_t N>
+constexpr StringMap<T, N> make_string_map(const std::pair<std::string_view, T> (&init)[N]) {
+    std::array<std::pair<std::string_view, T>, N> entries {};
+    for (std::size_t i = 0; i < N; ++i)
+        entries[i] = init[i];
+    return StringMap<T, N>(entries);
+}
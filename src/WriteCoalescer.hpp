@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include "InputParser.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief collects register writes and keeps only the last value of each register (see --coalesce)
+ *
+ * @details
+ * Uses a dense dirty bitmap and a value array per register type. The written registers are returned in address order.
+ * Only the part of the bitmap that contains dirty registers is scanned.
+ */
+class WriteCoalescer {
+private:
+    static constexpr std::size_t REGISTER_TYPES = 4;
+    static constexpr std::size_t WORD_BITS      = 64;
+
+    struct register_data_t {
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> dirty;
+        std::size_t           first_word = SIZE_MAX;  // first bitmap word that contains a dirty bit
+        std::size_t           last_word  = 0;         // last bitmap word that contains a dirty bit
+    };
+
+    std::array<register_data_t, REGISTER_TYPES> data;
+
+public:
+    /**
+     * @brief create coalescer
+     * @param elements number of registers per register type (DO, DI, AO, AI)
+     */
+    explicit WriteCoalescer(const std::array<std::size_t, REGISTER_TYPES> &elements) {
+        for (std::size_t i = 0; i < REGISTER_TYPES; ++i) {
+            data[i].values.resize(elements[i]);
+            data[i].dirty.resize((elements[i] + WORD_BITS - 1) / WORD_BITS);
+        }
+    }
+
+    /**
+     * @brief store value of a register (overwrites a previous value)
+     * @param type register type
+     * @param address register address (has to be in range)
+     * @param value register value
+     */
+    void set(InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+        auto      &reg  = data[static_cast<std::size_t>(type)];
+        const auto word = address / WORD_BITS;
+
+        reg.values[address] = value;
+        reg.dirty[word] |= uint64_t {1} << (address % WORD_BITS);
+        if (word < reg.first_word) reg.first_word = word;
+        if (word > reg.last_word) reg.last_word = word;
+    }
+
+    /**
+     * @brief call function for all stored registers of a type in address order and clear them
+     * @param type register type
+     * @param f function (address, value)
+     */
+    template <typename F>
+    void consume(InputParser::Instruction::register_type_t type, F &&f) {
+        auto &reg = data[static_cast<std::size_t>(type)];
+        if (reg.first_word == SIZE_MAX) return;
+
+        for (std::size_t word = reg.first_word; word <= reg.last_word; ++word) {
+            auto bits = reg.dirty[word];
+            while (bits) {
+                const auto address = word * WORD_BITS + static_cast<std::size_t>(std::countr_zero(bits));
+                f(address, reg.values[address]);
+                bits &= bits - 1;
+            }
+            reg.dirty[word] = 0;
+        }
+
+        reg.first_word = SIZE_MAX;
+        reg.last_word  = 0;
+    }
+};
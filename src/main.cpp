@@ -3,24 +3,61 @@
  * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
  */
 
+#include "BinaryInput.hpp"
+#include "Generator.hpp"
+#include "Histogram.hpp"
+#include "History.hpp"
 #include "InputParser.hpp"
+#include "LineReader.hpp"
+#include "Metrics.hpp"
+#include "OutputBuffer.hpp"
+#include "RegisterPublish.hpp"
+#include "RegisterShadow.hpp"
+#include "Replay.hpp"
+#include "ShmMapping.hpp"
+#include "ShmSnapshot.hpp"
+#include "ShmTarget.hpp"
+#include "ShmWatch.hpp"
+#include "SpscQueue.hpp"
+#include "WriteCoalescer.hpp"
 #include "license.hpp"
 #include "readline.hpp"
 
 #include "cxxsemaphore.hpp"
 #include "cxxshm.hpp"
 #include "generated/version_info.hpp"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <csignal>
+#include <cstdio>
+#include <cstring>
 #include <cxxendian/endian.hpp>
 #include <cxxopts.hpp>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
 #include <sysexits.h>
 #include <thread>
 #include <unistd.h>
@@ -34,6 +71,31 @@ static constexpr double MIN_BASH_SLEEP = 0.1;
 //! number of digits that have to be printed for bash sleep instructions
 constexpr int SLEEP_DIGITS = 1;
 
+//* size of the input buffer for binary input (has to hold at least one record)
+static constexpr std::size_t BINARY_BUFFER_SIZE = 1024 * 1024;
+static_assert(BINARY_BUFFER_SIZE >= BinaryInput::MAX_RECORD_SIZE);
+
+//* maximum number of lines per chunk of the parse pipeline (if the batch size is smaller)
+static constexpr std::size_t PIPELINE_CHUNK_LINES = 256;
+
+//* maximum number of chunks per parser thread in the parse pipeline queues
+static constexpr std::size_t PIPELINE_QUEUE_SIZE = 8;
+
+//* maximum number of parser threads
+static constexpr std::size_t PIPELINE_MAX_THREADS = 256;
+
+//* maximum number of interactive input lines that are not yet applied (interactive front end)
+static constexpr std::size_t INTERACTIVE_QUEUE_SIZE = 64;
+
+//* number of lines for which the transaction buffers are preallocated
+static constexpr std::size_t TRANSACTION_RESERVE_LINES = 1024;
+
+//* number of characters for which the transaction line buffer (copy of the staged lines) is preallocated
+static constexpr std::size_t TRANSACTION_RESERVE_TEXT = 64 * 1024;
+
+//* maximum sleep time of the generator thread (delay until a new generator writes the first sample)
+static constexpr std::chrono::milliseconds GENERATOR_MAX_SLEEP(10);
+
 //* value to increment error counter if semaphore could not be acquired
 static constexpr long SEMAPHORE_ERROR_INC = 10;
 
@@ -43,6 +105,15 @@ static constexpr long SEMAPHORE_ERROR_DEC = 1;
 //* maximum value of semaphore error counter
 static constexpr long SEMAPHORE_ERROR_MAX = 100;
 
+//* time to spin (non blocking attempts) before the semaphore is acquired with a blocking wait
+static constexpr std::chrono::microseconds SEMAPHORE_SPIN_TIME(20);
+
+//* maximum factor for the semaphore timeout (doubled after each failed attempt)
+static constexpr double SEMAPHORE_BACKOFF_MAX = 8.0;
+
+//* pause after the hold time budget was exceeded (POSIX semaphores are not fair, give waiting processes a chance)
+static constexpr std::chrono::microseconds SEMAPHORE_HANDOFF_TIME(50);
+
 constexpr std::array<int, 10> TERM_SIGNALS = {SIGINT,
                                               SIGTERM,
                                               SIGHUP,
@@ -54,6 +125,20 @@ constexpr std::array<int, 10> TERM_SIGNALS = {SIGINT,
                                               SIGUSR2,
                                               SIGVTALRM};
 
+//* interval to check if the Modbus client is alive (only if pidfd_open is not available)
+static constexpr int CLIENT_POLL_INTERVAL_MS = 100;
+
+//* eventfd that wakes up the main event loop
+static int wakeup_fd = -1;
+
+/**
+ * @brief wake up the main event loop (async signal safe)
+ */
+static void wake_main_loop() {
+    const uint64_t              one    = 1;
+    [[maybe_unused]] const auto result = write(wakeup_fd, &one, sizeof(one));
+}
+
 /*! \brief main function
  *
  * @param argc number of arguments
@@ -61,6 +146,8 @@ constexpr std::array<int, 10> TERM_SIGNALS = {SIGINT,
  * @return exit code
  */
 int main(int argc, char **argv) {
+    const auto startup_time = std::chrono::steady_clock::now();  // --startup-timing
+
     const std::string exe_name = std::filesystem::path(*argv).filename().string();
     cxxopts::Options  options(exe_name, "Read instructions from stdin and write them to a Modbus shared memory");
 
@@ -69,17 +156,42 @@ int main(int argc, char **argv) {
         exit(EX_USAGE);
     };
 
-    // establish signal handler
-    static volatile bool terminate = false;
-    struct sigaction     term_sa {};
-    term_sa.sa_handler = [](int) { terminate = true; };
-    term_sa.sa_flags   = SA_RESTART;
-    sigemptyset(&term_sa.sa_mask);
-    for (const auto SIGNO : TERM_SIGNALS) {
-        if (sigaction(SIGNO, &term_sa, nullptr)) {
-            perror("Failed to establish signal handler");
-            return EX_OSERR;
-        }
+    static std::atomic<bool> terminate = false;
+
+    wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd < 0) {
+        perror("Failed to create eventfd");
+        return EX_OSERR;
+    }
+
+    // termination signals are blocked in all threads and handled by the main event loop (signalfd)
+    // SIGPIPE is generated for the writing thread and can therefore not be handled via signalfd
+    sigset_t term_sigset {};
+    sigemptyset(&term_sigset);
+    for (const auto SIGNO : TERM_SIGNALS)
+        if (SIGNO != SIGPIPE) sigaddset(&term_sigset, SIGNO);
+
+    if (pthread_sigmask(SIG_BLOCK, &term_sigset, nullptr)) {
+        std::cerr << "Failed to block signals" << '\n';
+        return EX_OSERR;
+    }
+
+    const int signal_fd = signalfd(-1, &term_sigset, SFD_CLOEXEC);
+    if (signal_fd < 0) {
+        perror("Failed to create signalfd");
+        return EX_OSERR;
+    }
+
+    struct sigaction pipe_sa {};
+    pipe_sa.sa_handler = [](int) {
+        terminate = true;
+        wake_main_loop();
+    };
+    pipe_sa.sa_flags = SA_RESTART;
+    sigemptyset(&pipe_sa.sa_mask);
+    if (sigaction(SIGPIPE, &pipe_sa, nullptr)) {
+        perror("Failed to establish signal handler");
+        return EX_OSERR;
     }
 
     // all command line arguments
@@ -96,7 +208,90 @@ int main(int argc, char **argv) {
                                     cxxopts::value<int>()->default_value("0"));
     options.add_options("settings")("p,passthrough", "write passthrough all executed commands to stdout");
     options.add_options("settings")("bash", "passthrough as bash script. No effect i '--passthrough' is not set");
+    options.add_options("settings")("timestamps",
+                                    "passthrough with timestamp lines (microseconds) that can be replayed with "
+                                    "'--replay'. No effect if '--passthrough' is not set.");
     options.add_options("settings")("valid-hist", "add only valid commands to command history");
+    options.add_options("settings")("history",
+                                    "file that stores the command history of the interactive mode. The history is "
+                                    "loaded at startup and new commands are appended in the background.",
+                                    cxxopts::value<std::string>());
+    options.add_options("settings")("history-size",
+                                    "maximum number of command history entries (0: unlimited). Only the last entries "
+                                    "of the history file are loaded.",
+                                    cxxopts::value<std::size_t>()->default_value("1000"));
+    options.add_options("settings")("line-buffered",
+                                    "write the output (passthrough, verbose) line by line. By default, the output is "
+                                    "buffered and written as soon as no further input is available. Always enabled if "
+                                    "the input is a terminal.");
+    options.add_options("settings")("batch-size",
+                                    "maximum number of input lines that are applied to the shared memory with a single "
+                                    "semaphore acquisition. Only relevant if the input is not a terminal.",
+                                    cxxopts::value<std::size_t>()->default_value("1"));
+    options.add_options("settings")("batch-window-us",
+                                    "maximum time (in microseconds) to wait for further input lines before an "
+                                    "incomplete batch is applied. No effect if '--batch-size' is 1.",
+                                    cxxopts::value<long>()->default_value("0"));
+    options.add_options("settings")("coalesce",
+                                    "write only the last value of each register within a batch (in address order). "
+                                    "Only useful in combination with '--batch-size'.");
+    options.add_options("settings")("skip-unchanged",
+                                    "do not write registers that already contain the value (compared to a local copy "
+                                    "of the values that were written). The passthrough output of these registers is "
+                                    "skipped, too. Changes by the Modbus client are not detected.");
+    options.add_options("settings")("input-format",
+                                    "format of the input data: 'text' (instruction lines) or 'binary' (framed register "
+                                    "records, see documentation).",
+                                    cxxopts::value<std::string>()->default_value("text"));
+    options.add_options("settings")("define",
+                                    "command template: NAME=INSTRUCTION. The input line 'NAME VALUE' executes the "
+                                    "instruction with the parameter $1 replaced by VALUE (e.g. "
+                                    "'setpoint=ao:1200:$1:f32_badc' and the input line 'setpoint 42.5'). Without $1, "
+                                    "the input line 'NAME' executes the instruction. Value lists are not possible "
+                                    "(',' separates multiple templates). Can be specified multiple times.",
+                                    cxxopts::value<std::vector<std::string>>());
+    options.add_options("replay")("replay",
+                                  "replay a recorded scenario file (see '--timestamps' and '--bash') instead of "
+                                  "reading from stdin",
+                                  cxxopts::value<std::string>());
+    options.add_options("replay")(
+            "speed", "replay speed factor (e.g. 2 for double speed)", cxxopts::value<double>()->default_value("1"));
+    options.add_options("monitor")("monitor",
+                                   "write the registers that were changed (e.g. by the Modbus client) to stdout "
+                                   "instead of reading instructions from stdin. The output can be used as input of "
+                                   "another instance.");
+    options.add_options("monitor")("poll-interval-ms",
+                                   "time (in milliseconds) between two comparisons of the shared memory (--monitor)",
+                                   cxxopts::value<double>()->default_value("10"));
+    options.add_options("performance")("parse-threads",
+                                       "number of parser threads. If not 0, the input is read, parsed and written to "
+                                       "the shared memory by different threads (input order is retained). Only "
+                                       "relevant if the input is not a terminal. Verbose output of the parser is not "
+                                       "available in this mode.",
+                                       cxxopts::value<std::size_t>()->default_value("0"));
+    options.add_options("performance")(
+            "writer-cpu", "pin the thread that writes to the shared memory to the given cpu", cxxopts::value<int>());
+    options.add_options("performance")("prefault",
+                                       "map all pages of the shared memory at startup (no page faults while the "
+                                       "semaphore is held)");
+    options.add_options("performance")("mlock", "lock the pages of the shared memory in memory");
+    options.add_options("performance")("startup-timing",
+                                       "print the time from the start of the application to the first write to the "
+                                       "shared memory (and to the end of the startup steps) to stderr");
+    options.add_options("performance")("hugepage",
+                                       "request transparent huge pages for the shared memory (only effective if "
+                                       "enabled for shared memory by the kernel)");
+    options.add_options("metrics")("metrics-json",
+                                   "periodically write the metrics as JSON object (one line) to stderr");
+    options.add_options("metrics")("metrics-shm",
+                                   "periodically write the metrics to the shared memory '<name-prefix>stats' (see "
+                                   "documentation for the layout)");
+    options.add_options("metrics")("metrics-socket",
+                                   "provide the metrics in the Prometheus text format (HTTP) via the given Unix socket",
+                                   cxxopts::value<std::string>());
+    options.add_options("metrics")("metrics-interval",
+                                   "interval (in seconds) of '--metrics-json' and '--metrics-shm'",
+                                   cxxopts::value<double>()->default_value("1"));
     options.add_options("other")("h,help", "print usage");
     options.add_options("other")("v,verbose", "print what is written to the registers");
     options.add_options("version information")("version", "print version and exit");
@@ -112,14 +307,40 @@ int main(int argc, char **argv) {
             "semaphore",
             "protect the shared memory with an existing named semaphore against simultaneous access",
             cxxopts::value<std::string>());
+    options.add_options("shared memory")("target",
+                                         "additional Modbus shared memory: NAME=PREFIX[:SEMAPHORE]. Lines that start "
+                                         "with 'NAME/' are written to the shared memory objects of this name prefix "
+                                         "(e.g. 'dev3/ao:10:42'). Can be specified multiple times.",
+                                         cxxopts::value<std::vector<std::string>>());
     options.add_options("shared memory")("semaphore-timeout",
                                          "maximum time (in seconds) to wait for semaphore (default: 0.1)",
                                          cxxopts::value<double>()->default_value("0.1"));
+    options.add_options("shared memory")("max-hold-us",
+                                         "maximum time (in microseconds) to hold the semaphore. Larger batches are "
+                                         "split and the semaphore is released in between. 0: no limit",
+                                         cxxopts::value<long>()->default_value("0"));
+    options.add_options("shared memory")("seqlock",
+                                         "provide sequence numbers for lock free readers in the shared memory "
+                                         "'<name-prefix>seqlock' (see documentation for the layout). Values of 32 and "
+                                         "64 bit data types are written while the sequence number is odd.");
+    options.add_options("shared memory")("types",
+                                         "register types whose shared memory objects are opened (e.g. 'ao,do'). "
+                                         "Writes to other register types are discarded (address out of range).",
+                                         cxxopts::value<std::vector<std::string>>()->default_value("do,di,ao,ai"));
+    options.add_options("shared memory")("semaphore-stats",
+                                         "print histograms of the semaphore wait and hold times on termination");
     options.add_options("shared_memory")(
             "pid",
             "terminate application if application with given pid is terminated. Provide "
             "the pid of the Modbus client to terminate when the Modbus client is terminated.",
             cxxopts::value<pid_t>());
+    options.add_options("shared_memory")("reattach",
+                                         "do not terminate if the Modbus client is terminated. Wait until the shared "
+                                         "memory and the semaphore of the restarted Modbus client are available and "
+                                         "continue with the new shared memory. The input is kept until then.");
+    options.add_options("shared_memory")("reattach-restore",
+                                         "write the last known register content to the shared memory of a restarted "
+                                         "Modbus client. No effect if '--reattach' is not set.");
 
     // parse arguments
     cxxopts::ParseResult args;
@@ -154,6 +375,15 @@ int main(int argc, char **argv) {
             std::cout << "               Use --data-types to get a list of supported data type identifiers." << '\n';
         else
             std::cout << "               Type 'help types' to get a list of supported data type identifiers." << '\n';
+        std::cout << '\n';
+        std::cout << "Block write formats:" << '\n';
+        std::cout << "    reg_type:start..end:value[:data_type]          write value to all registers of the range"
+                  << '\n';
+        std::cout << "    reg_type:address:[value,...][:data_type]       write list of values to consecutive registers"
+                  << '\n';
+        std::cout << "    reg_type:start..end:[value,...][:data_type]    repeat list of values in the range" << '\n';
+        std::cout << "    reg_type:address:hex:data                      write raw hex data (memory byte order)"
+                  << '\n';
     };
 
     // print usage
@@ -229,12 +459,12 @@ int main(int argc, char **argv) {
                   << '\n';
         std::cout << "      - 64 Bit:" << '\n';
         std::cout << "          - f64_abcdefgh, f64_big, f64b            64-Bit floating point   in big endian" << '\n';
-        std::cout << "          - f64_ghefcdab, f64_little, f64l         64-Bit floating point   in little endian"
+        std::cout << "          - f64_hgfedcba, f64_little, f64l         64-Bit floating point   in little endian"
                   << '\n';
-        std::cout << "          - f64_badcfehg, f64_big_rev, f64br       64-Bit floating point   in big endian,     - "
+        std::cout << "          - f64_ghefcdab, f64_big_rev, f64br       64-Bit floating point   in big endian,     - "
                      "reversed register order"
                   << '\n';
-        std::cout << "          - f64_hgfedcba, f64_little_rev, f64lr    64-Bit floating point   in little endian,  - "
+        std::cout << "          - f64_badcfehg, f64_little_rev, f64lr    64-Bit floating point   in little endian,  - "
                      "reversed register order"
                   << '\n';
         std::cout << "  - Int:" << '\n';
@@ -341,85 +571,253 @@ int main(int argc, char **argv) {
     const bool VERBOSE          = args.count("verbose");
     const bool PASSTHROUGH      = args.count("passthrough");
     const bool PASSTHROUGH_BASH = args.count("bash");
-    const bool INTERACTIVE      = isatty(STDIN_FILENO) == 1;  // enable command history if input is tty
+    const bool PASSTHROUGH_TS   = args.count("timestamps");
+    const bool REPLAY           = args.count("replay");
+    const bool MONITOR          = args.count("monitor");
+    const bool INTERACTIVE      = !REPLAY && !MONITOR && isatty(STDIN_FILENO) == 1;  // command history if input is tty
     const bool VALID_HIST       = args.count("valid-hist");
+    const bool LINE_BUFFERED    = INTERACTIVE || args.count("line-buffered");
+    const bool REATTACH         = args.count("reattach");
+    const bool REATTACH_RESTORE = REATTACH && args.count("reattach-restore");
 
     std::unique_ptr<Readline> readline;
-    if (INTERACTIVE) { readline = std::make_unique<Readline>(); }
+    std::unique_ptr<History>  history;
+    if (INTERACTIVE) {
+        readline = std::make_unique<Readline>();
+        try {
+            history = std::make_unique<History>(args.count("history") ? args["history"].as<std::string>() : "",
+                                                args["history-size"].as<std::size_t>());
+        } catch (const std::system_error &e) {
+            std::cerr << e.what() << '\n';
+            return EX_CANTCREAT;
+        }
+    }
 
     const std::string REGISTER_ENDIAN = endian::HostEndianness.isBig() ? "u16b" : "u16l";
 
     // open shared memory objects
     const auto &name_prefix = args["name-prefix"].as<std::string>();
 
+    const bool STARTUP_TIMING = args.count("startup-timing");
+    const auto startup_options = std::chrono::steady_clock::now();
+
+    // register types whose shared memory objects are opened (--types, index: register type)
+    std::array<bool, 4> OPEN_TYPES {};
+    for (const auto &type : args["types"].as<std::vector<std::string>>()) {
+        const auto *name = std::find(Metrics::REGISTER_TYPE_NAMES.begin(), Metrics::REGISTER_TYPE_NAMES.end(), type);
+        if (name == Metrics::REGISTER_TYPE_NAMES.end()) {
+            std::cerr << "types: unknown register type '" << type << "' (expected do, di, ao or ai)" << '\n';
+            return EX_USAGE;
+        }
+        OPEN_TYPES[static_cast<std::size_t>(name - Metrics::REGISTER_TYPE_NAMES.begin())] = true;
+    }
+
+    // the shared memory objects of the register types that are not opened are nullptr (0 registers)
     std::unique_ptr<cxxshm::SharedMemory> shm_do;
     std::unique_ptr<cxxshm::SharedMemory> shm_di;
     std::unique_ptr<cxxshm::SharedMemory> shm_ao;
     std::unique_ptr<cxxshm::SharedMemory> shm_ai;
 
+    // size of a shared memory object (0 if it is not opened)
+    auto shm_size = [](const std::unique_ptr<cxxshm::SharedMemory> &shm) -> std::size_t {
+        return shm ? shm->get_size() : 0;
+    };
+
     try {
-        shm_do = std::make_unique<cxxshm::SharedMemory>(name_prefix + "DO");
-        shm_di = std::make_unique<cxxshm::SharedMemory>(name_prefix + "DI");
-        shm_ao = std::make_unique<cxxshm::SharedMemory>(name_prefix + "AO");
-        shm_ai = std::make_unique<cxxshm::SharedMemory>(name_prefix + "AI");
+        if (OPEN_TYPES[0]) shm_do = std::make_unique<cxxshm::SharedMemory>(name_prefix + "DO");
+        if (OPEN_TYPES[1]) shm_di = std::make_unique<cxxshm::SharedMemory>(name_prefix + "DI");
+        if (OPEN_TYPES[2]) shm_ao = std::make_unique<cxxshm::SharedMemory>(name_prefix + "AO");
+        if (OPEN_TYPES[3]) shm_ai = std::make_unique<cxxshm::SharedMemory>(name_prefix + "AI");
     } catch (const std::system_error &e) {
         std::cerr << e.what() << '\n';
         return EX_OSERR;
     }
 
     // check shared mem
-    if (shm_do->get_size() > MAX_MODBUS_REGS) {
+    if (shm_size(shm_do) > MAX_MODBUS_REGS) {
         std::cerr << "shared memory '" << shm_do->get_name() << "is to large to be a valid Modbus shared memory."
                   << '\n';
         return EX_SOFTWARE;
     }
 
-    if (shm_di->get_size() > MAX_MODBUS_REGS) {
+    if (shm_size(shm_di) > MAX_MODBUS_REGS) {
         std::cerr << "shared memory '" << shm_di->get_name() << "' is to large to be a valid Modbus shared memory."
                   << '\n';
         return EX_SOFTWARE;
     }
 
-    if (shm_ao->get_size() / 2 > MAX_MODBUS_REGS) {
+    if (shm_size(shm_ao) / 2 > MAX_MODBUS_REGS) {
         std::cerr << "shared memory '" << shm_ao->get_name() << "' is to large to be a valid Modbus shared memory."
                   << '\n';
         return EX_SOFTWARE;
     }
 
-    if (shm_ai->get_size() / 2 > MAX_MODBUS_REGS) {
+    if (shm_size(shm_ai) / 2 > MAX_MODBUS_REGS) {
         std::cerr << "shared memory '" << shm_ai->get_name() << "' is to large to be a valid Modbus shared memory."
                   << '\n';
         return EX_SOFTWARE;
     }
 
     if (VERBOSE) {
-        std::cerr << "DO registers: " << shm_do->get_size() << '\n';
-        std::cerr << "DI registers: " << shm_di->get_size() << '\n';
-        std::cerr << "AO registers: " << shm_ao->get_size() / 2 << '\n';
-        std::cerr << "AI registers: " << shm_ai->get_size() / 2 << '\n';
+        std::cerr << "DO registers: " << shm_size(shm_do) << '\n';
+        std::cerr << "DI registers: " << shm_size(shm_di) << '\n';
+        std::cerr << "AO registers: " << shm_size(shm_ao) / 2 << '\n';
+        std::cerr << "AI registers: " << shm_size(shm_ai) / 2 << '\n';
     }
 
-    if (shm_ao->get_size() % 2) {
+    if (shm_size(shm_ao) % 2) {
         std::cerr << "the size of shared memory '" << shm_ao->get_name() << "' is odd. It is not a valid Modbus shm."
                   << '\n';
         return EX_SOFTWARE;
     }
 
-    if (shm_ai->get_size() % 2) {
+    if (shm_size(shm_ai) % 2) {
         std::cerr << "the size of shared memory '" << shm_ai->get_name() << "' is odd. It is not a valid Modbus shm."
                   << '\n';
         return EX_SOFTWARE;
     }
 
-    const std::size_t do_elements = shm_do->get_size();
-    const std::size_t di_elements = shm_di->get_size();
-    const std::size_t ao_elements = shm_ao->get_size() / 2;
-    const std::size_t ai_elements = shm_ai->get_size() / 2;
+    // prepare the shared memory mappings (--prefault, --mlock, --hugepage)
+    const bool PREFAULT = args.count("prefault");
+    const bool MLOCK    = args.count("mlock");
+    const bool HUGEPAGE = args.count("hugepage");
+
+    // throws std::system_error if a mapping can not be prefaulted or locked
+    auto prepare_mappings = [&](const std::array<const cxxshm::SharedMemory *, 4> &mappings) {
+        for (const auto *shm : mappings) {
+            if (!shm) continue;  // not opened (--types)
+            if (HUGEPAGE && !ShmMapping::advise_hugepage(*shm)) {
+                std::cerr << "WARNING: huge pages are not available for shared memory '" << shm->get_name() << "'\n";
+            }
+            if (PREFAULT) ShmMapping::prefault(*shm);
+            if (MLOCK) ShmMapping::lock(*shm);
+        }
+    };
+
+    if (PREFAULT || MLOCK || HUGEPAGE) {
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            prepare_mappings({shm_do.get(), shm_di.get(), shm_ao.get(), shm_ai.get()});
+        } catch (const std::system_error &e) {
+            std::cerr << e.what() << '\n';
+            return EX_OSERR;
+        }
+
+        if (VERBOSE) {
+            const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+            std::cerr << "shared memory prepared in " << duration.count() << " ms" << '\n';
+        }
+    }
+
+    const std::size_t do_elements = shm_size(shm_do);
+    const std::size_t di_elements = shm_size(shm_di);
+    const std::size_t ao_elements = shm_size(shm_ao) / 2;
+    const std::size_t ai_elements = shm_size(shm_ai) / 2;
+
+    const auto                            startup_shm = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point startup_input;  // start of the input thread
 
     const int addr_base  = args["address-base"].as<int>();
     const int value_base = args["value-base"].as<int>();
 
-    std::mutex m;  // to ensure that the program is not terminated while it writes to a shared memory
+    // batch mode (not available for interactive input)
+    const std::size_t BATCH_SIZE      = INTERACTIVE ? 1 : args["batch-size"].as<std::size_t>();
+    const long        BATCH_WINDOW_US = args["batch-window-us"].as<long>();
+    if (BATCH_SIZE == 0) {
+        std::cerr << "batch-size: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    if (BATCH_WINDOW_US < 0) {
+        std::cerr << "batch-window-us: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    const bool BATCH_MODE = BATCH_SIZE > 1;
+    const bool COALESCE   = args.count("coalesce");
+    const bool SKIP_SAME  = args.count("skip-unchanged");
+
+    // metrics
+    const bool   METRICS_JSON       = args.count("metrics-json");
+    const bool   METRICS_SHM        = args.count("metrics-shm");
+    const bool   METRICS_SOCKET     = args.count("metrics-socket");
+    const bool   METRICS            = METRICS_JSON || METRICS_SHM || METRICS_SOCKET;  // enables time measurements
+    const double METRICS_INTERVAL_S = args["metrics-interval"].as<double>();
+    if (METRICS_INTERVAL_S < 0.001) {
+        std::cerr << "metrics-interval: invalid value" << '\n';
+        return EX_USAGE;
+    }
+
+    // input format
+    const auto &input_format = args["input-format"].as<std::string>();
+    if (input_format != "text" && input_format != "binary") {
+        std::cerr << "input-format: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    const bool BINARY_INPUT = input_format == "binary";
+    if (BINARY_INPUT && INTERACTIVE) {
+        std::cerr << "binary input is not possible if the input is a terminal" << '\n';
+        return EX_USAGE;
+    }
+
+    if (PASSTHROUGH_BASH && PASSTHROUGH_TS) {
+        std::cerr << "the options '--bash' and '--timestamps' can not be combined" << '\n';
+        return EX_USAGE;
+    }
+
+    // parse pipeline (not available for interactive input)
+    const std::size_t PARSE_THREADS = INTERACTIVE ? 0 : args["parse-threads"].as<std::size_t>();
+    if (PARSE_THREADS > PIPELINE_MAX_THREADS) {
+        std::cerr << "parse-threads: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    if (PARSE_THREADS && (BINARY_INPUT || REPLAY)) {
+        std::cerr << "the option '--parse-threads' is only available for text input from stdin" << '\n';
+        return EX_USAGE;
+    }
+
+    const int WRITER_CPU = args.count("writer-cpu") ? args["writer-cpu"].as<int>() : -1;
+    if (args.count("writer-cpu") && (WRITER_CPU < 0 || WRITER_CPU >= CPU_SETSIZE)) {
+        std::cerr << "writer-cpu: invalid value" << '\n';
+        return EX_USAGE;
+    }
+
+    // replay
+    const double REPLAY_SPEED = args["speed"].as<double>();
+    if (!(REPLAY_SPEED > 0)) {
+        std::cerr << "speed: invalid value" << '\n';
+        return EX_USAGE;
+    }
+
+    // monitor
+    const double POLL_INTERVAL_MS = args["poll-interval-ms"].as<double>();
+    if (!(POLL_INTERVAL_MS > 0)) {
+        std::cerr << "poll-interval-ms: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    if (MONITOR && (REPLAY || BINARY_INPUT || PARSE_THREADS)) {
+        std::cerr << "the option '--monitor' can not be combined with '--replay', '--input-format binary' and "
+                     "'--parse-threads'"
+                  << '\n';
+        return EX_USAGE;
+    }
+
+    std::unique_ptr<Replay::MappedFile> replay_file;
+    if (REPLAY) {
+        if (BINARY_INPUT) {
+            std::cerr << "replay of binary input is not supported" << '\n';
+            return EX_USAGE;
+        }
+
+        try {
+            replay_file = std::make_unique<Replay::MappedFile>(args["replay"].as<std::string>());
+        } catch (const std::system_error &e) {
+            std::cerr << e.what() << '\n';
+            return EX_NOINPUT;
+        }
+    }
+
+    // to ensure that the program is not terminated while it writes to a shared memory
+    // std::cout and std::cerr are only used while m is locked as soon as the input thread is started (see OutputBuffer)
+    std::mutex m;
 
     std::unique_ptr<cxxsemaphore::Semaphore> semaphore;
     long                                     semaphore_error_counter = 0;
@@ -438,6 +836,115 @@ int main(int argc, char **argv) {
         std::cerr << std::flush;
     }
 
+    // additional shared memory targets (--target). The index of a target in a batch entry is its position + 1.
+    std::vector<std::unique_ptr<ShmTarget>>          targets;
+    std::map<std::string, std::size_t, std::less<>> target_index;
+    if (args.count("target")) {
+        if (COALESCE || SKIP_SAME || REATTACH || BINARY_INPUT || PARSE_THREADS) {
+            std::cerr << "the option '--target' can not be combined with '--coalesce', '--skip-unchanged', "
+                         "'--reattach', '--input-format binary' and '--parse-threads'"
+                      << '\n';
+            return EX_USAGE;
+        }
+
+        for (const auto &definition : args["target"].as<std::vector<std::string>>()) {
+            try {
+                targets.emplace_back(std::make_unique<ShmTarget>(definition));
+            } catch (const std::invalid_argument &e) {
+                std::cerr << "target: " << e.what() << '\n';
+                return EX_USAGE;
+            } catch (const std::system_error &e) {
+                std::cerr << e.what() << '\n';
+                return EX_OSERR;
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << '\n';
+                return EX_SOFTWARE;
+            }
+
+            if (!target_index.emplace(targets.back()->get_name(), targets.size()).second) {
+                std::cerr << "target: duplicate target name '" << targets.back()->get_name() << "'\n";
+                return EX_USAGE;
+            }
+        }
+    }
+
+    // command templates (--define)
+    struct command_template_t {
+        InputParser::Template tpl;
+        std::size_t           target = 0;  // see batch_entry_t
+    };
+    std::map<std::string, command_template_t, std::less<>> templates;
+    if (args.count("define")) {
+        const std::array<std::size_t, 4> elements {do_elements, di_elements, ao_elements, ai_elements};
+
+        for (const auto &definition : args["define"].as<std::vector<std::string>>()) {
+            const auto equal = definition.find('=');
+            const auto name  = definition.substr(0, equal);
+            if (equal == std::string::npos || name.empty() || name.find_first_of(":/ \t") != std::string::npos ||
+                name == "begin" || name == "commit" || name == "abort" || name == "gen") {
+                std::cerr << "define: invalid template '" << definition << "' (expected NAME=INSTRUCTION)" << '\n';
+                return EX_USAGE;
+            }
+
+            // optional target selector
+            std::string_view   instruction = std::string_view(definition).substr(equal + 1);
+            command_template_t command;
+            const auto         slash = instruction.find('/');
+            if (slash != std::string_view::npos && slash < instruction.find(':')) {
+                const auto it = target_index.find(instruction.substr(0, slash));
+                if (it == target_index.end()) {
+                    std::cerr << "define: unknown target '" << instruction.substr(0, slash) << "'\n";
+                    return EX_USAGE;
+                }
+                command.target = it->second;
+                instruction.remove_prefix(slash + 1);
+            }
+
+            try {
+                command.tpl = InputParser::compile_template(instruction, addr_base, value_base);
+            } catch (const std::exception &e) {
+                std::cerr << "define: template '" << name << "': " << e.what() << '\n';
+                return EX_USAGE;
+            }
+
+            const auto type  = command.tpl.register_type;
+            const auto count = command.target ? targets[command.target - 1]->register_count(type)
+                                              : elements[static_cast<std::size_t>(type)];
+            if (command.tpl.address >= count || command.tpl.registers > count - command.tpl.address) {
+                std::cerr << "define: template '" << name << "': address out of range" << '\n';
+                return EX_USAGE;
+            }
+
+            if (!templates.emplace(name, std::move(command)).second) {
+                std::cerr << "define: duplicate template name '" << name << "'\n";
+                return EX_USAGE;
+            }
+        }
+    }
+
+    // execute command template (--define). Returns false if the line does not start with the name of a template.
+    auto parse_template = [&](std::string_view              line,
+                              InputParser::Instructions    &instructions,
+                              std::size_t                  &target,
+                              bool                          verbose) -> bool {
+        if (templates.empty()) return false;
+
+        const auto separator = line.find_first_of(" \t");
+        const auto it        = templates.find(line.substr(0, separator));
+        if (it == templates.end()) return false;
+
+        const auto value = separator == std::string_view::npos ? std::string_view() : line.substr(separator + 1);
+        const auto &[tpl, tpl_target] = it->second;
+        if (tpl.parameter && value.find_first_not_of(" \t") == std::string_view::npos)
+            throw std::invalid_argument("Missing value of template '" + it->first + '\'');
+        if (!tpl.parameter && value.find_first_not_of(" \t") != std::string_view::npos)
+            throw std::invalid_argument("Template '" + it->first + "' has no parameter");
+
+        InputParser::expand_template(tpl, value, instructions, value_base, verbose);
+        target = tpl_target;
+        return true;
+    };
+
     const double SEMAPHORE_TIMEOUT_S = args["semaphore-timeout"].as<double>();
     if (SEMAPHORE_TIMEOUT_S < 0.000'001) {
         std::cerr << "semaphore-timeout: invalid value" << '\n';
@@ -450,6 +957,21 @@ int main(int argc, char **argv) {
             static_cast<suseconds_t>(std::modf(SEMAPHORE_TIMEOUT_S, &modf_dummy) * 1'000'000),
     };
 
+    // semaphore timeout with the same representation as SEMAPHORE_MAX_TIME
+    auto semaphore_timeout = [](double seconds) {
+        double integral {};
+        const double fraction = std::modf(seconds, &integral);
+        return timespec {static_cast<time_t>(integral), static_cast<suseconds_t>(fraction * 1'000'000)};
+    };
+
+    const long MAX_HOLD_US = args["max-hold-us"].as<long>();
+    if (MAX_HOLD_US < 0) {
+        std::cerr << "max-hold-us: invalid value" << '\n';
+        return EX_USAGE;
+    }
+    const std::chrono::microseconds MAX_HOLD(MAX_HOLD_US);
+    const bool                      SEMAPHORE_STATS = args.count("semaphore-stats");
+
     // modbus client pid
     pid_t mb_client_pid     = 0;
     bool  use_mb_client_pid = false;
@@ -460,238 +982,2068 @@ int main(int argc, char **argv) {
         std::cerr << "WARNING: No Modbus client pid provided.\n"
                      "         Terminating the Modbus client application WILL NOT result in the termination of this "
                      "application.\n"
-                     "         This application WILL NOT connect to the shared memory of a restarted Modbus client.\n"
-                     "         Use --pid to specify the pid of the Modbus client.\n"
+                  << (REATTACH ? ""
+                               : "         This application WILL NOT connect to the shared memory of a restarted "
+                                 "Modbus client.\n")
+                  << "         Use --pid to specify the pid of the Modbus client.\n"
                      "         Command line example: --pid $(pidof modbus-tcp-client-shm)\n"
                   << std::flush;
     }
 
+    // watch the shared memory files of the Modbus client (--reattach)
+    std::vector<std::string>  client_files;
+    std::vector<ino_t>        client_inodes;  // inodes of the files of the attached Modbus client
+    std::unique_ptr<ShmWatch> shm_watch;
+    if (REATTACH) {
+        for (const auto *shm : {&shm_do, &shm_di, &shm_ao, &shm_ai})
+            if (*shm) client_files.emplace_back(ShmWatch::shm_file((*shm)->get_name()));
+        if (semaphore) client_files.emplace_back(ShmWatch::semaphore_file(semaphore->get_name()));
+
+        try {
+            shm_watch = std::make_unique<ShmWatch>(client_files);
+        } catch (const std::system_error &e) {
+            std::cerr << e.what() << '\n';
+            return EX_OSERR;
+        }
+
+        for (const auto &file : client_files)
+            client_inodes.push_back(ShmWatch::inode(file));
+    }
+
+    // report that a shared memory provided by the application could not be created
+    // (the name is reported explicitly if the shared memory already exists, e.g. left behind by a killed instance)
+    auto shm_create_error = [](const std::string &name, const std::system_error &e) {
+        if (e.code() == std::errc::file_exists) {
+            std::cerr << "shared memory '" << name << "' already exists. Another instance is running or a terminated "
+                      << "instance left it behind (remove /dev/shm/" << name << " if it is not used)." << '\n';
+        } else {
+            std::cerr << e.what() << '\n';
+        }
+    };
+
+    // metrics shared memory (--metrics-shm)
+    std::unique_ptr<cxxshm::SharedMemory> metrics_shm;
+    MetricsShm                           *metrics_shm_data = nullptr;
+    if (METRICS_SHM) {
+        try {
+            metrics_shm = std::make_unique<cxxshm::SharedMemory>(name_prefix + "stats", sizeof(MetricsShm));
+        } catch (const std::system_error &e) {
+            shm_create_error(name_prefix + "stats", e);
+            return EX_OSERR;
+        }
+        metrics_shm_data = new (metrics_shm->get_addr<void *>()) MetricsShm;
+    }
+
+    // seqlock shared memory (--seqlock)
+    std::unique_ptr<cxxshm::SharedMemory> seqlock_shm;
+    RegisterSeqlock                      *seqlock = nullptr;
+    if (args.count("seqlock")) {
+        try {
+            seqlock_shm = std::make_unique<cxxshm::SharedMemory>(name_prefix + "seqlock", sizeof(RegisterSeqlock));
+        } catch (const std::system_error &e) {
+            shm_create_error(name_prefix + "seqlock", e);
+            return EX_OSERR;
+        }
+        seqlock = new (seqlock_shm->get_addr<void *>()) RegisterSeqlock;
+    }
+
+    // enclose writes of analog registers in the seqlock section of the register type (--seqlock)
+    auto seqlock_begin = [&](InputParser::Instruction::register_type_t type) {
+        if (seqlock && (type == InputParser::Instruction::register_type_t::AO ||
+                        type == InputParser::Instruction::register_type_t::AI))
+            seqlock->begin(type);
+    };
+    auto seqlock_end = [&](InputParser::Instruction::register_type_t type) {
+        if (seqlock && (type == InputParser::Instruction::register_type_t::AO ||
+                        type == InputParser::Instruction::register_type_t::AI))
+            seqlock->end(type);
+    };
+
+    // metrics socket (--metrics-socket)
+    const std::string metrics_socket_path = METRICS_SOCKET ? args["metrics-socket"].as<std::string>() : "";
+    int               metrics_socket      = -1;
+    if (METRICS_SOCKET) {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        if (metrics_socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "metrics-socket: path too long" << '\n';
+            return EX_USAGE;
+        }
+        metrics_socket_path.copy(address.sun_path, metrics_socket_path.size());
+
+        // remove the socket of a previous instance (only if it is a socket)
+        struct stat socket_stat {};
+        if (stat(metrics_socket_path.c_str(), &socket_stat) == 0 && S_ISSOCK(socket_stat.st_mode))
+            unlink(metrics_socket_path.c_str());
+
+        metrics_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (metrics_socket < 0 ||
+            bind(metrics_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) ||  // NOLINT
+            listen(metrics_socket, SOMAXCONN)) {
+            perror("Failed to create metrics socket");
+            return EX_OSERR;
+        }
+    }
+
+    // timer of the periodic metrics output (--metrics-json, --metrics-shm)
+    int metrics_timer = -1;
+    if (METRICS_JSON || METRICS_SHM) {
+        metrics_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (metrics_timer < 0) {
+            perror("Failed to create metrics timer");
+            return EX_OSERR;
+        }
+
+        const auto interval_ns = static_cast<long>(METRICS_INTERVAL_S * 1e9);
+        itimerspec timer_spec {};
+        timer_spec.it_interval.tv_sec  = interval_ns / 1'000'000'000;
+        timer_spec.it_interval.tv_nsec = interval_ns % 1'000'000'000;
+        timer_spec.it_value            = timer_spec.it_interval;
+        if (timerfd_settime(metrics_timer, 0, &timer_spec, nullptr)) {
+            perror("Failed to start metrics timer");
+            return EX_OSERR;
+        }
+    }
+
+    // the writing threads wait while the Modbus client is not attached (--reattach). Modified while m is locked.
+    std::atomic<bool>       client_attached = true;
+    std::condition_variable client_cv;
+
     std::cout << std::fixed;
 
+    // terminate output line (flushed only in line buffered mode)
+    auto end_line = [LINE_BUFFERED](std::ostream &o) {
+        o << '\n';
+        if (LINE_BUFFERED) o << std::flush;
+    };
+
+    // startup timing (--startup-timing): printed after the first write to the shared memory (m has to be locked)
+    bool startup_reported  = !STARTUP_TIMING;
+    auto report_first_write = [&]() {
+        if (startup_reported) return;
+        startup_reported = true;
+
+        auto ms = [&](const std::chrono::steady_clock::time_point &time) {
+            return std::chrono::duration<double, std::milli>(time - startup_time).count();
+        };
+
+        std::cerr << "startup timing (ms since start of main): options " << ms(startup_options) << ", shared memory "
+                  << ms(startup_shm) << ", input thread " << ms(startup_input) << ", first write "
+                  << ms(std::chrono::steady_clock::now());
+        end_line(std::cerr);
+    };
+
     auto last_time  = std::chrono::steady_clock::now();
-    auto bash_sleep = [&last_time]() {
+    auto bash_sleep = [&last_time, &end_line]() {
         auto this_time  = std::chrono::steady_clock::now();
         auto ms         = std::chrono::duration_cast<std::chrono::milliseconds>(this_time - last_time).count();
         auto sleep_time = static_cast<double>(ms) / 1000.0;
         if (sleep_time > MIN_BASH_SLEEP) {
             last_time = this_time;
-            std::cout << "sleep " << std::setprecision(SLEEP_DIGITS) << sleep_time << std::endl;  // NOLINT
+            std::cout << "sleep " << std::setprecision(SLEEP_DIGITS) << sleep_time;
+            end_line(std::cout);
         }
     };
 
-    auto input_thread_func = [&] {
-        while (!terminate) {
-            std::string line;
-            if (INTERACTIVE) {
-                try {
-                    line = readline->get_line(">>> ");
-                } catch (const std::runtime_error &) {
-                    // eof
-                    break;
-                }
+    // timestamp lines for --replay (microseconds since start, only written if the time changed)
+    const auto start_time     = std::chrono::steady_clock::now();
+    int64_t    last_timestamp = -1;
+
+    auto write_timestamp = [&]() {
+        const auto elapsed   = std::chrono::steady_clock::now() - start_time;
+        const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        if (timestamp != last_timestamp) {
+            last_timestamp = timestamp;
+            std::cout << Replay::TIMESTAMP_PREFIX << timestamp;
+            end_line(std::cout);
+        }
+    };
 
-                if (line == "exit") break;
+    //* input line and the instructions that result from it
+    struct batch_entry_t {
+        std::string_view                      line;  // valid until the batch is applied (not copied)
+        InputParser::Instructions             instructions;
+        std::chrono::steady_clock::time_point time;  // time the line was read (only if metrics are enabled)
+        std::size_t                           target = 0;  // 0: --name-prefix, otherwise index in targets + 1
+    };
 
-                if (line == "help") {
-                    std::cout << "usage: help {format, constants, types}" << '\n';
-                    std::cout << '\n';
-                    std::cout << "    Type 'exit' to exit the application." << std::endl;  // NOLINT
-                    continue;
-                }
+    std::vector<batch_entry_t> batch;
+
+    // arena for the patterns of the block instructions of the current batch (released after the batch is applied).
+    // The memory is kept by the pool: no heap allocations in the steady state.
+    std::pmr::unsynchronized_pool_resource batch_pool;
+    std::pmr::monotonic_buffer_resource    batch_arena(&batch_pool);
+
+    //* input lines between 'begin' and 'commit' (applied together with a single semaphore acquisition)
+    struct transaction_t {
+        bool                                             active = false;
+        bool                                             failed = false;  // a staged line was invalid
+        std::string                                      text;            // copy of the staged lines
+        std::vector<std::pair<std::size_t, std::size_t>> lines;           // position and size of the lines in text
+        std::vector<batch_entry_t>                       entries;         // line is set on commit
+    } transaction;
+    transaction.text.reserve(TRANSACTION_RESERVE_TEXT);
+    transaction.lines.reserve(TRANSACTION_RESERVE_LINES);
+    transaction.entries.reserve(TRANSACTION_RESERVE_LINES);
+
+    // append entry to the current batch or stage it if a transaction is active
+    auto stage_entry = [&](batch_entry_t entry) {
+        if (!transaction.active) {
+            batch.push_back(std::move(entry));
+            return;
+        }
 
-                if (line == "help format") {
-                    print_format(false);
-                    add_history(line.c_str());
-                    continue;
-                }
+        // the line is copied: the input buffer is reused before the transaction is committed
+        transaction.lines.emplace_back(transaction.text.size(), entry.line.size());
+        transaction.text.append(entry.line);
+        entry.line = {};
+        transaction.entries.push_back(entry);  // copy: the batch arena is released before the commit
+    };
 
-                if (line == "help constants") {
-                    print_constants();
-                    add_history(line.c_str());
-                    continue;
-                }
+    // batch statistics (only modified while m is locked)
+    std::size_t stat_lines    = 0;
+    std::size_t stat_acquires = 0;
+    std::size_t stat_skipped  = 0;  // writes of unchanged registers (--skip-unchanged)
 
-                if (line == "help types") {
-                    print_data_types();
-                    add_history(line.c_str());
-                    continue;
-                }
+    // metrics (only modified while m is locked)
+    Metrics metrics;
 
-                if (!line.empty() && !VALID_HIST) add_history(line.c_str());
-            } else {
-                if (!std::getline(std::cin, line)) break;
-            }
+    // buffered reader for non-interactive input
+    LineReader line_reader(STDIN_FILENO);
 
+    // write buffered output
+    auto flush_output = [&]() {
+        std::lock_guard<std::mutex> guard(m);
+        std::cout << std::flush;
+        std::cerr << std::flush;
+    };
 
-            // parse input
-            std::vector<InputParser::Instruction> instructions;
-            try {
-                instructions = InputParser::parse(line, addr_base, value_base, VERBOSE);
-            } catch (std::exception &e) {
-                std::cerr << "line '" << line << "' discarded: " << e.what() << std::endl;  // NOLINT
-                continue;
-            }
+    // get next line from the line reader (reads more data if required). Returns false at the end of the input.
+    auto next_line = [&](std::string_view &line) {
+        while (!line_reader.get_line(line)) {
+            if (line_reader.is_eof()) return false;
+            flush_output();  // the read call might block
+            line_reader.fill();
+        }
+        return true;
+    };
 
-            if (INTERACTIVE && VALID_HIST) add_history(line.c_str());
+    auto elapsed_ns = [](const std::chrono::steady_clock::time_point &since) {
+        const auto elapsed = std::chrono::steady_clock::now() - since;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    };
 
-            // write value to target
-            std::lock_guard<std::mutex> guard(m);
+    auto elapsed_us = [](const std::chrono::steady_clock::time_point &since) {
+        const auto elapsed = std::chrono::steady_clock::now() - since;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    };
 
-            if (semaphore) {
-                while (!semaphore->wait(SEMAPHORE_MAX_TIME)) {
-                    std::cerr << " WARNING: Failed to acquire semaphore '" << semaphore->get_name() << "' within "
-                              << SEMAPHORE_TIMEOUT_S << "s." << std::endl;  // NOLINT
+    // count discarded line (parser exception)
+    auto count_parse_error = [&](const std::exception &e) {
+        if (dynamic_cast<const InputParser::unknown_type_error *>(&e)) ++metrics.discarded_unknown_type;
+        else
+            ++metrics.discarded_parse_error;
+    };
 
-                    semaphore_error_counter += SEMAPHORE_ERROR_INC;
+    // report discarded line (address out of range)
+    auto discard_out_of_range = [&](std::string_view line) {
+        ++metrics.discarded_out_of_range;
+        std::cerr << "line '" << line << "' discarded: address out of range";
+        end_line(std::cerr);
+    };
 
-                    if (semaphore_error_counter >= SEMAPHORE_ERROR_MAX) {
-                        std::cerr << "ERROR: Repeatedly failed to acquire the semaphore\n";
-                        return EX_SOFTWARE;
+    // parse input line and append the resulting instructions to the current batch
+    auto parse_line = [&](std::string_view line) {
+        std::lock_guard<std::mutex> guard(m);  // the parser writes to std::cerr in verbose mode
+
+        ++metrics.lines_read;
+        const auto time = METRICS ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+        InputParser::Instructions instructions(&batch_arena);
+        std::size_t               target = 0;
+        try {
+            if (!parse_template(line, instructions, target, VERBOSE)) {
+                // target selector (--target): 'NAME/' in front of the instruction
+                std::string_view instruction_line = line;
+                const auto       slash            = targets.empty() ? std::string_view::npos : line.find('/');
+                if (slash != std::string_view::npos && slash < line.find(':')) {
+                    const auto it = target_index.find(line.substr(0, slash));
+                    if (it == target_index.end()) {
+                        throw InputParser::unknown_type_error("unknown target '" + std::string(line.substr(0, slash)) +
+                                                              '\'');
                     }
+                    target           = it->second;
+                    instruction_line = line.substr(slash + 1);
                 }
 
-                semaphore_error_counter -= SEMAPHORE_ERROR_DEC;
-                if (semaphore_error_counter < 0) semaphore_error_counter = 0;
+                InputParser::parse(instruction_line, instructions, addr_base, value_base, VERBOSE);
             }
+        } catch (std::exception &e) {
+            count_parse_error(e);
+            if (transaction.active) transaction.failed = true;
+            std::cerr << "line '" << line << "' discarded: " << e.what();
+            end_line(std::cerr);
+            return;
+        }
 
-            for (auto &input_data : instructions) {
-                switch (input_data.register_type) {
-                    case InputParser::Instruction::register_type_t::DO: {
-                        if (input_data.address >= do_elements) {
-                            std::cerr << "line '" << line << "' discarded: address out of range"
-                                      << std::endl;  // NOLINT
-                            break;
-                        }
-                        uint8_t value                                     = input_data.value ? 1 : 0;
-                        shm_do->get_addr<uint8_t *>()[input_data.address] = value;
-                        if (VERBOSE) {
-                            std::cerr << "> write " << std::hex << "0x" << std::setw(2) << std::setfill('0') << value
-                                      << " to DO @0x" << std::setw(4) << input_data.address << std::endl;  // NOLINT
-                        }
+        if (METRICS) metrics.parse_time_ns.add(elapsed_ns(time));
+        ++metrics.lines_parsed;
 
-                        if (PASSTHROUGH) {
-                            if (PASSTHROUGH_BASH) {
-                                bash_sleep();
-                                std::cout << "echo '";
-                            }
-                            std::cout << "do:" << input_data.address << ':' << static_cast<int>(value);
-                            if (PASSTHROUGH_BASH) std::cout << "'";
-                            std::cout << std::endl;  // NOLINT
-                        }
+        if (INTERACTIVE && VALID_HIST) history->add(std::string(line));
 
-                        break;
-                    }
-                    case InputParser::Instruction::register_type_t::DI: {
-                        if (input_data.address >= di_elements) {
-                            std::cerr << "line '" << line << "' discarded: address out of range"
-                                      << std::endl;  // NOLINT
-                            break;
-                        }
-                        uint8_t value                                     = input_data.value ? 1 : 0;
-                        shm_di->get_addr<uint8_t *>()[input_data.address] = value;
+        stage_entry({line, std::move(instructions), time, target});
+    };
 
-                        if (VERBOSE) {
-                            std::cerr << "> write " << std::hex << "0x" << std::setw(2) << std::setfill('0') << value
-                                      << " to DI @0x" << std::setw(4) << input_data.address << std::endl;  // NOLINT
-                        }
+    // semaphore statistics (only modified while m is locked, the histograms are part of the metrics)
+    std::size_t stat_splits = 0;  // batches that were split because of the hold time budget
+    auto        hold_start  = std::chrono::steady_clock::now();
 
-                        if (PASSTHROUGH) {
-                            if (PASSTHROUGH_BASH) {
-                                bash_sleep();
-                                std::cout << "echo '";
-                            }
-                            std::cout << "di:" << input_data.address << ':' << static_cast<int>(value);
-                            if (PASSTHROUGH_BASH) std::cout << "'";
-                            std::cout << std::endl;  // NOLINT
-                        }
+    // acquire a semaphore. Returns false if the semaphore could not be acquired repeatedly.
+    // Non blocking attempts first, then a timed wait. The timeout is doubled after every failed attempt.
+    auto wait_semaphore = [&](cxxsemaphore::Semaphore &sem) -> bool {
+        const auto wait_start = std::chrono::steady_clock::now();
 
-                        break;
-                    }
-                    case InputParser::Instruction::register_type_t::AO:
-                        if (input_data.address >= ao_elements) {
-                            std::cerr << "line '" << line << "' discarded: address out of range"
-                                      << std::endl;  // NOLINT
-                            break;
-                        }
-                        shm_ao->get_addr<uint16_t *>()[input_data.address] = static_cast<uint16_t>(input_data.value);
+        bool acquired = sem.try_wait();
+        while (!acquired && std::chrono::steady_clock::now() - wait_start < SEMAPHORE_SPIN_TIME)
+            acquired = sem.try_wait();
 
-                        if (VERBOSE) {
-                            std::cerr << "> write " << std::hex << "0x" << std::setw(4) << std::setfill('0')
-                                      << input_data.value << " to AO @0x" << std::setw(4) << input_data.address
-                                      << std::endl;  // NOLINT
-                        }
+        double timeout_s = SEMAPHORE_TIMEOUT_S;
+        while (!acquired && !sem.wait(semaphore_timeout(timeout_s))) {
+            if (!client_attached) return false;  // Modbus client terminated (--reattach)
 
-                        if (PASSTHROUGH) {
-                            if (PASSTHROUGH_BASH) {
-                                bash_sleep();
-                                std::cout << "echo '";
-                            }
-                            std::cout << "ao:" << input_data.address << ':' << static_cast<uint16_t>(input_data.value)
-                                      << ':' << REGISTER_ENDIAN;
-                            if (PASSTHROUGH_BASH) std::cout << "'";
-                            std::cout << std::endl;  // NOLINT
-                        }
-                        break;
-                    case InputParser::Instruction::register_type_t::AI:
-                        if (input_data.address >= ai_elements) {
-                            std::cerr << "line '" << line << "' discarded: address out of range"
-                                      << std::endl;  // NOLINT
-                            break;
-                        }
-                        shm_ai->get_addr<uint16_t *>()[input_data.address] = static_cast<uint16_t>(input_data.value);
+            std::cerr << " WARNING: Failed to acquire semaphore '" << sem.get_name() << "' within "
+                      << timeout_s << "s." << std::endl;  // NOLINT
 
-                        if (VERBOSE) {
-                            std::cerr << "> write " << std::hex << "0x" << std::setw(4) << std::setfill('0')
-                                      << input_data.value << " to AI @0x" << std::setw(4) << input_data.address
-                                      << std::endl;  // NOLINT
-                        }
+            semaphore_error_counter += SEMAPHORE_ERROR_INC;
+            ++metrics.semaphore_timeouts;
 
-                        if (PASSTHROUGH) {
-                            if (PASSTHROUGH_BASH) {
-                                bash_sleep();
-                                std::cout << "echo '";
-                            }
-                            std::cout << "ai:" << input_data.address << ':' << static_cast<uint16_t>(input_data.value)
-                                      << ':' << REGISTER_ENDIAN;
-                            if (PASSTHROUGH_BASH) std::cout << "'";
-                            std::cout << std::endl;  // NOLINT
-                        }
-                        break;
-                }
+            if (semaphore_error_counter >= SEMAPHORE_ERROR_MAX) {
+                std::cerr << "ERROR: Repeatedly failed to acquire the semaphore\n";
+                return false;
             }
 
-            if (semaphore && semaphore->is_acquired()) semaphore->post();
+            timeout_s = std::min(timeout_s * 2.0, SEMAPHORE_TIMEOUT_S * SEMAPHORE_BACKOFF_MAX);
         }
 
-        rl_clear_history();
-        terminate = true;
-        return EX_OK;
+        metrics.semaphore_wait_us.add(elapsed_us(wait_start));
+        hold_start = std::chrono::steady_clock::now();
+
+        semaphore_error_counter -= SEMAPHORE_ERROR_DEC;
+        if (semaphore_error_counter < 0) semaphore_error_counter = 0;
+        return true;
     };
 
-    // start input thread.
-    // a detached thread will be terminated by its destructor as soon as the thread object is out of scope
-    // (end of function main)
-    std::thread input_thread(input_thread_func);
-    input_thread.detach();
+    // release a semaphore (if acquired)
+    auto post_semaphore = [&](cxxsemaphore::Semaphore *sem) {
+        if (sem && sem->is_acquired()) {
+            sem->post();
+            metrics.semaphore_hold_us.add(elapsed_us(hold_start));
+        }
+    };
 
-    while (!terminate) {
-        if (use_mb_client_pid) {
-            // check if modbus client is still alive
-            int tmp = kill(mb_client_pid, 0);
-            if (tmp == -1) {
-                if (errno == ESRCH) {
-                    std::cerr << "Modbus client (pid=" << mb_client_pid << ") no longer alive.\n" << std::flush;
-                } else {
-                    perror("failed to send signal to the Modbus client");
-                }
-                terminate = true;
-                break;
+    // acquire/release the semaphore of the Modbus client (if any)
+    auto acquire_semaphore = [&]() { return !semaphore || wait_semaphore(*semaphore); };
+    auto release_semaphore = [&]() { post_semaphore(semaphore.get()); };
+
+    // wait until the Modbus client is attached (--reattach) and acquire the semaphore (m has to be locked).
+    // Returns false if the semaphore could not be acquired repeatedly or the application is terminated.
+    auto acquire_client = [&](std::unique_lock<std::mutex> &lock) -> bool {
+        while (true) {
+            client_cv.wait(lock, [&] { return client_attached || terminate; });
+            if (terminate) return false;
+
+            if (acquire_semaphore()) {
+                if (client_attached) return true;
+                release_semaphore();  // the Modbus client was terminated meanwhile
+            } else if (client_attached) {
+                return false;
             }
         }
+    };
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // NOLINT
+    // release and reacquire the semaphore if the hold time budget (--max-hold-us) is exceeded (m has to be locked)
+    // Returns false if the semaphore could not be acquired again.
+    bool hold_transaction = false;  // a transaction is applied: the semaphore is not released in between
+    auto check_hold_budget = [&](std::unique_lock<std::mutex> &lock) -> bool {
+        if (hold_transaction || !MAX_HOLD_US || !semaphore) return true;
+        if (std::chrono::steady_clock::now() - hold_start < MAX_HOLD) return true;
+
+        release_semaphore();
+        ++stat_splits;
+        std::this_thread::sleep_for(SEMAPHORE_HANDOFF_TIME);
+        if (!acquire_client(lock)) return false;
+
+        if (PASSTHROUGH && PASSTHROUGH_TS) write_timestamp();
+        return true;
+    };
+
+    // pin the calling thread to the cpu specified by --writer-cpu
+    auto pin_writer_thread = [&]() {
+        if (WRITER_CPU < 0) return;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(static_cast<std::size_t>(WRITER_CPU), &cpu_set);
+        const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (error) {
+            std::lock_guard<std::mutex> guard(m);
+            std::cerr << "WARNING: failed to pin writer thread to cpu " << WRITER_CPU << ": " << strerror(error)
+                      << std::endl;  // NOLINT
+        }
+    };
+
+    // number of registers of the given type
+    auto register_count = [&](InputParser::Instruction::register_type_t type) -> std::size_t {
+        switch (type) {
+            case InputParser::Instruction::register_type_t::DO: return do_elements;
+            case InputParser::Instruction::register_type_t::DI: return di_elements;
+            case InputParser::Instruction::register_type_t::AO: return ao_elements;
+            case InputParser::Instruction::register_type_t::AI: return ai_elements;
+        }
+        return 0;
+    };
+
+    // verbose and passthrough output of a register write
+    // (target: name of the target (--target), empty for the shared memory of --name-prefix)
+    auto print_write = [&](InputParser::Instruction::register_type_t type,
+                           std::size_t                               address,
+                           uint16_t                                  value,
+                           std::string_view                          target = {}) {
+        static constexpr std::array<const char *, 4> UPPER_NAMES = {"DO", "DI", "AO", "AI"};
+        static constexpr std::array<const char *, 4> LOWER_NAMES = {"do", "di", "ao", "ai"};
+
+        const auto index = static_cast<std::size_t>(type);
+        const bool coil  = type == InputParser::Instruction::register_type_t::DO ||
+                          type == InputParser::Instruction::register_type_t::DI;
+
+        if (VERBOSE) {
+            std::cerr << "> write " << std::hex << "0x" << std::setw(coil ? 2 : 4) << std::setfill('0');
+            if (coil) std::cerr << static_cast<uint8_t>(value);
+            else
+                std::cerr << value;
+            std::cerr << " to ";
+            if (!target.empty()) std::cerr << target << '/';
+            std::cerr << UPPER_NAMES[index] << " @0x" << std::setw(4) << address;
+            end_line(std::cerr);
+        }
+
+        if (PASSTHROUGH) {
+            if (PASSTHROUGH_BASH) {
+                bash_sleep();
+                std::cout << "echo '";
+            }
+            if (!target.empty()) std::cout << target << '/';
+            std::cout << LOWER_NAMES[index] << ':' << address << ':' << value;
+            if (!coil) std::cout << ':' << REGISTER_ENDIAN;
+            if (PASSTHROUGH_BASH) std::cout << "'";
+            end_line(std::cout);
+        }
+    };
+
+    // metrics, verbose and passthrough output of a single register write
+    auto report_write = [&](InputParser::Instruction::register_type_t type,
+                            std::size_t                               address,
+                            uint16_t                                  value,
+                            std::string_view                          target = {}) {
+        ++metrics.registers_written[static_cast<std::size_t>(type)];
+        print_write(type, address, value, target);
+    };
+
+    // report_write for the write loops of the shared memory of --name-prefix
+    // output: std::true_type if --verbose or --passthrough is set, otherwise std::false_type. The quiet instantiations
+    // of the write loops (batch, block, register run, coalesced batch, generator sample and binary records) do not
+    // contain any output code.
+    const bool OUTPUT = VERBOSE || PASSTHROUGH;
+
+    auto report_register = [&](auto                                      output,
+                               InputParser::Instruction::register_type_t type,
+                               std::size_t                               address,
+                               uint16_t                                  value) {
+        ++metrics.registers_written[static_cast<std::size_t>(type)];
+        if constexpr (decltype(output)::value) print_write(type, address, value);
+    };
+
+    // write a single register to the shared memory (the address has to be in range, coil values have to be 0 or 1)
+    auto write_register = [&](InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+        switch (type) {
+            case InputParser::Instruction::register_type_t::DO:
+                shm_do->get_addr<uint8_t *>()[address] = static_cast<uint8_t>(value);
+                break;
+            case InputParser::Instruction::register_type_t::DI:
+                shm_di->get_addr<uint8_t *>()[address] = static_cast<uint8_t>(value);
+                break;
+            case InputParser::Instruction::register_type_t::AO: shm_ao->get_addr<uint16_t *>()[address] = value; break;
+            case InputParser::Instruction::register_type_t::AI: shm_ai->get_addr<uint16_t *>()[address] = value; break;
+        }
+    };
+
+    // shadow image of the registers (--skip-unchanged). Initialized with the current shared memory content.
+    std::unique_ptr<RegisterShadow> shadow;
+
+    auto load_shadow = [&]() {
+        if (!shadow) return;
+        if (shm_do) shadow->load(InputParser::Instruction::register_type_t::DO, shm_do->get_addr<const uint8_t *>());
+        if (shm_di) shadow->load(InputParser::Instruction::register_type_t::DI, shm_di->get_addr<const uint8_t *>());
+        if (shm_ao) shadow->load(InputParser::Instruction::register_type_t::AO, shm_ao->get_addr<const uint16_t *>());
+        if (shm_ai) shadow->load(InputParser::Instruction::register_type_t::AI, shm_ai->get_addr<const uint16_t *>());
+    };
+
+    if (SKIP_SAME) {
+        shadow = std::make_unique<RegisterShadow>(
+                std::array<std::size_t, 4> {do_elements, di_elements, ao_elements, ai_elements});
+        load_shadow();
+    }
+
+    // true if the register already contains the value (--skip-unchanged). Otherwise, the shadow image is updated.
+    auto skip_write = [&](InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+        if (!shadow || shadow->update(type, address, value)) return false;
+        ++stat_skipped;
+        return true;
+    };
+
+    // write block instruction to the shared memory (single bounds check, the pattern is copied or filled)
+    // (output: see report_register)
+    auto apply_block = [&](auto output, std::string_view line, const InputParser::BlockInstruction &block) {
+        const auto  type         = block.register_type;
+        const auto &pattern      = block.pattern;
+        const auto  pattern_size = pattern.size();
+
+        const auto elements = register_count(type);
+        if (block.address >= elements || block.count > elements - block.address) {
+            discard_out_of_range(line);
+            return;
+        }
+
+        const bool coil = type == InputParser::Instruction::register_type_t::DO ||
+                          type == InputParser::Instruction::register_type_t::DI;
+
+        if (shadow) {
+            // only the changed registers are written
+            seqlock_begin(type);
+            for (std::size_t i = 0; i < block.count; ++i) {
+                uint16_t value = pattern[i % pattern_size];
+                if (coil) value = value ? 1 : 0;
+                if (skip_write(type, block.address + i, value)) continue;
+                write_register(type, block.address + i, value);
+                report_register(output, type, block.address + i, value);
+            }
+            seqlock_end(type);
+            return;
+        }
+
+        seqlock_begin(type);
+        switch (type) {
+            case InputParser::Instruction::register_type_t::DO:
+            case InputParser::Instruction::register_type_t::DI: {
+                auto &shm = type == InputParser::Instruction::register_type_t::DO ? shm_do : shm_di;
+                auto *dst = shm->get_addr<uint8_t *>() + block.address;
+                if (pattern_size == 1) {
+                    std::fill_n(dst, block.count, pattern[0] ? 1 : 0);
+                } else {
+                    for (std::size_t i = 0; i < block.count; ++i)
+                        dst[i] = pattern[i % pattern_size] ? 1 : 0;
+                }
+                break;
+            }
+            case InputParser::Instruction::register_type_t::AO:
+            case InputParser::Instruction::register_type_t::AI: {
+                auto &shm = type == InputParser::Instruction::register_type_t::AO ? shm_ao : shm_ai;
+                auto *dst = shm->get_addr<uint16_t *>() + block.address;
+                if (pattern_size == 1) {
+                    std::fill_n(dst, block.count, pattern[0]);
+                } else {
+                    for (std::size_t i = 0; i < block.count; i += pattern_size)
+                        std::memcpy(dst + i, pattern.data(), pattern_size * sizeof(uint16_t));
+                }
+                break;
+            }
+        }
+        seqlock_end(type);
+
+        metrics.registers_written[static_cast<std::size_t>(type)] += block.count;
+        if constexpr (decltype(output)::value) {
+            for (std::size_t i = 0; i < block.count; ++i) {
+                uint16_t value = pattern[i % pattern_size];
+                if (coil) value = value ? 1 : 0;
+                print_write(type, block.address + i, value);
+            }
+        }
+    };
+
+    // write contiguous analog registers (see register_run): single bounds check, single atomic store if aligned
+    auto apply_run = [&](auto                                      output,
+                         std::string_view                          line,
+                         InputParser::Instruction::register_type_t type,
+                         std::size_t                               address,
+                         const uint16_t                           *values,
+                         std::size_t                               count) {
+        const auto elements = register_count(type);
+        if (address >= elements || count > elements - address) {
+            discard_out_of_range(line);
+            return;
+        }
+
+        std::array<bool, InputParser::Instructions::CAPACITY> written {};
+        seqlock_begin(type);
+        if (shadow) {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (skip_write(type, address + i, values[i])) continue;
+                write_register(type, address + i, values[i]);
+                written[i] = true;
+            }
+        } else {
+            auto &shm = type == InputParser::Instruction::register_type_t::AO ? shm_ao : shm_ai;
+            publish_registers(shm->get_addr<uint16_t *>() + address, values, count);
+            std::fill_n(written.begin(), count, true);
+        }
+        seqlock_end(type);
+
+        for (std::size_t i = 0; i < count; ++i)
+            if (written[i]) report_register(output, type, address + i, values[i]);
+    };
+
+    std::unique_ptr<WriteCoalescer> coalescer;
+    if (COALESCE) {
+        coalescer = std::make_unique<WriteCoalescer>(
+                std::array<std::size_t, 4> {do_elements, di_elements, ao_elements, ai_elements});
+    }
+
+    // write the last value of every register of the current batch in address order (m has to be locked)
+    // (output: see report_register)
+    auto apply_batch_coalesced_impl = [&](auto output) {
+        auto coalesce = [&](InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+            const bool coil = type == InputParser::Instruction::register_type_t::DO ||
+                              type == InputParser::Instruction::register_type_t::DI;
+            coalescer->set(type, address, coil ? static_cast<uint16_t>(value ? 1 : 0) : value);
+        };
+
+        std::array<uint16_t, InputParser::Instructions::CAPACITY> run_values {};
+        for (const auto &entry : batch) {
+            // a value that does not fit completely into the shared memory is discarded as a whole (see apply_run)
+            if (const auto run = register_run(entry.instructions, run_values)) {
+                const auto &first    = entry.instructions[0];
+                const auto  elements = register_count(first.register_type);
+                if (first.address >= elements || run > elements - first.address) {
+                    discard_out_of_range(entry.line);
+                    continue;
+                }
+            }
+
+            for (const auto &input_data : entry.instructions) {
+                if (input_data.address >= register_count(input_data.register_type)) {
+                    discard_out_of_range(entry.line);
+                    continue;
+                }
+                coalesce(input_data.register_type, input_data.address, input_data.value);
+            }
+
+            if (const auto &block = entry.instructions.get_block()) {
+                const auto elements = register_count(block->register_type);
+                if (block->address >= elements || block->count > elements - block->address) {
+                    discard_out_of_range(entry.line);
+                    continue;
+                }
+                for (std::size_t i = 0; i < block->count; ++i)
+                    coalesce(block->register_type, block->address + i, block->pattern[i % block->pattern.size()]);
+            }
+        }
+
+        coalescer->consume(InputParser::Instruction::register_type_t::DO, [&](std::size_t address, uint16_t value) {
+            if (skip_write(InputParser::Instruction::register_type_t::DO, address, value)) return;
+            shm_do->get_addr<uint8_t *>()[address] = static_cast<uint8_t>(value);
+            report_register(output, InputParser::Instruction::register_type_t::DO, address, value);
+        });
+        coalescer->consume(InputParser::Instruction::register_type_t::DI, [&](std::size_t address, uint16_t value) {
+            if (skip_write(InputParser::Instruction::register_type_t::DI, address, value)) return;
+            shm_di->get_addr<uint8_t *>()[address] = static_cast<uint8_t>(value);
+            report_register(output, InputParser::Instruction::register_type_t::DI, address, value);
+        });
+        seqlock_begin(InputParser::Instruction::register_type_t::AO);
+        coalescer->consume(InputParser::Instruction::register_type_t::AO, [&](std::size_t address, uint16_t value) {
+            if (skip_write(InputParser::Instruction::register_type_t::AO, address, value)) return;
+            shm_ao->get_addr<uint16_t *>()[address] = value;
+            report_register(output, InputParser::Instruction::register_type_t::AO, address, value);
+        });
+        seqlock_end(InputParser::Instruction::register_type_t::AO);
+        seqlock_begin(InputParser::Instruction::register_type_t::AI);
+        coalescer->consume(InputParser::Instruction::register_type_t::AI, [&](std::size_t address, uint16_t value) {
+            if (skip_write(InputParser::Instruction::register_type_t::AI, address, value)) return;
+            shm_ai->get_addr<uint16_t *>()[address] = value;
+            report_register(output, InputParser::Instruction::register_type_t::AI, address, value);
+        });
+        seqlock_end(InputParser::Instruction::register_type_t::AI);
+    };
+
+    // one instantiation is selected by the output options
+    auto apply_batch_coalesced = [&]() {
+        if (OUTPUT) apply_batch_coalesced_impl(std::true_type());
+        else
+            apply_batch_coalesced_impl(std::false_type());
+    };
+
+    // write all instructions of the current batch to the shared memory in input order (m has to be locked)
+    // Returns false if the semaphore could not be acquired again after the hold time budget was exceeded.
+    // (output: see report_register)
+    auto apply_batch_direct_impl = [&](auto output, std::unique_lock<std::mutex> &lock) -> bool {
+        std::array<uint16_t, InputParser::Instructions::CAPACITY> run_values {};
+        for (auto &entry : batch) {
+            if (const auto run = register_run(entry.instructions, run_values)) {
+                const auto &first = entry.instructions[0];
+                apply_run(output, entry.line, first.register_type, first.address, run_values.data(), run);
+                if (!check_hold_budget(lock)) return false;
+                continue;
+            }
+
+            for (const auto &input_data : entry.instructions) {
+                const auto type    = input_data.register_type;
+                const auto address = input_data.address;
+
+                switch (type) {
+                    case InputParser::Instruction::register_type_t::DO: {
+                        if (address >= do_elements) {
+                            discard_out_of_range(entry.line);
+                            break;
+                        }
+                        const uint8_t value = input_data.value ? 1 : 0;
+                        if (skip_write(type, address, value)) break;
+                        shm_do->get_addr<uint8_t *>()[address] = value;
+                        report_register(output, type, address, value);
+                        break;
+                    }
+                    case InputParser::Instruction::register_type_t::DI: {
+                        if (address >= di_elements) {
+                            discard_out_of_range(entry.line);
+                            break;
+                        }
+                        const uint8_t value = input_data.value ? 1 : 0;
+                        if (skip_write(type, address, value)) break;
+                        shm_di->get_addr<uint8_t *>()[address] = value;
+                        report_register(output, type, address, value);
+                        break;
+                    }
+                    case InputParser::Instruction::register_type_t::AO:
+                        if (address >= ao_elements) {
+                            discard_out_of_range(entry.line);
+                            break;
+                        }
+                        if (skip_write(type, address, input_data.value)) break;
+                        shm_ao->get_addr<uint16_t *>()[address] = input_data.value;
+                        report_register(output, type, address, input_data.value);
+                        break;
+                    case InputParser::Instruction::register_type_t::AI:
+                        if (address >= ai_elements) {
+                            discard_out_of_range(entry.line);
+                            break;
+                        }
+                        if (skip_write(type, address, input_data.value)) break;
+                        shm_ai->get_addr<uint16_t *>()[address] = input_data.value;
+                        report_register(output, type, address, input_data.value);
+                        break;
+                }
+            }
+
+            if (const auto &block = entry.instructions.get_block()) apply_block(output, entry.line, *block);
+
+            if (!check_hold_budget(lock)) return false;
+        }
+        return true;
+    };
+
+    // one instantiation is selected by the output options
+    auto apply_batch_direct = [&](std::unique_lock<std::mutex> &lock) -> bool {
+        if (OUTPUT) return apply_batch_direct_impl(std::true_type(), lock);
+        return apply_batch_direct_impl(std::false_type(), lock);
+    };
+
+    // write the instructions of a batch entry to an additional target (--target)
+    auto apply_target_entry = [&](ShmTarget &target, const batch_entry_t &entry) {
+        auto write = [&](InputParser::Instruction::register_type_t type, std::size_t address, uint16_t value) {
+            const bool coil = type == InputParser::Instruction::register_type_t::DO ||
+                              type == InputParser::Instruction::register_type_t::DI;
+            if (coil) value = value ? 1 : 0;
+            target.write(type, address, value);
+            report_write(type, address, value, target.get_name());
+        };
+
+        for (const auto &input_data : entry.instructions) {
+            if (input_data.address >= target.register_count(input_data.register_type)) {
+                discard_out_of_range(entry.line);
+                continue;
+            }
+            write(input_data.register_type, input_data.address, input_data.value);
+        }
+
+        if (const auto &block = entry.instructions.get_block()) {
+            const auto elements = target.register_count(block->register_type);
+            if (block->address >= elements || block->count > elements - block->address) {
+                discard_out_of_range(entry.line);
+                return;
+            }
+            for (std::size_t i = 0; i < block->count; ++i)
+                write(block->register_type, block->address + i, block->pattern[i % block->pattern.size()]);
+        }
+    };
+
+    // write the entries of the current batch that belong to additional targets (--target) and remove them from the
+    // batch: one semaphore acquisition per target, input order per target (m has to be locked)
+    // Returns false if a semaphore could not be acquired repeatedly.
+    auto apply_targets = [&]() -> bool {
+        for (std::size_t t = 1; t <= targets.size(); ++t) {
+            auto &target   = *targets[t - 1];
+            bool  acquired = false;
+            for (const auto &entry : batch) {
+                if (entry.target != t) continue;
+
+                if (!acquired) {
+                    if (target.get_semaphore() && !wait_semaphore(*target.get_semaphore())) return false;
+                    acquired = true;
+                    ++stat_acquires;
+                    if (PASSTHROUGH && PASSTHROUGH_TS) write_timestamp();
+                }
+                apply_target_entry(target, entry);
+            }
+            if (acquired) post_semaphore(target.get_semaphore());
+        }
+
+        std::erase_if(batch, [&](const batch_entry_t &entry) {
+            if (!entry.target) return false;
+            if (METRICS) metrics.latency_us.add(elapsed_us(entry.time));
+            ++stat_lines;
+            return true;
+        });
+        return true;
+    };
+
+    // write all instructions of the current batch to the shared memory (single semaphore acquisition)
+    auto apply_batch = [&]() -> bool {
+        if (batch.empty()) {
+            batch_arena.release();  // patterns of discarded lines
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(m);
+
+        if (!targets.empty()) {
+            if (!apply_targets()) return false;
+            if (batch.empty()) {
+                batch_arena.release();
+                return true;
+            }
+        }
+
+        if (!acquire_client(lock)) return false;
+
+        if (PASSTHROUGH && PASSTHROUGH_TS) write_timestamp();
+
+        bool success = true;
+        if (COALESCE) apply_batch_coalesced();
+        else
+            success = apply_batch_direct(lock);
+
+        release_semaphore();
+        if (!success) return false;
+        report_first_write();
+
+        if (METRICS) {
+            for (const auto &entry : batch)
+                metrics.latency_us.add(elapsed_us(entry.time));
+        }
+
+        stat_lines += batch.size();
+        ++stat_acquires;
+        batch.clear();
+        batch_arena.release();
+        return true;
+    };
+
+    // true if all instructions of the entry are within the shared memory
+    auto entry_in_range = [&](const batch_entry_t &entry) {
+        auto count = [&](InputParser::Instruction::register_type_t type) {
+            return entry.target ? targets[entry.target - 1]->register_count(type) : register_count(type);
+        };
+
+        for (const auto &input_data : entry.instructions)
+            if (input_data.address >= count(input_data.register_type)) return false;
+        if (const auto &block = entry.instructions.get_block()) {
+            const auto elements = count(block->register_type);
+            return block->address < elements && block->count <= elements - block->address;
+        }
+        return true;
+    };
+
+    // execute transaction command (begin, commit, abort).
+    // Returns std::nullopt if the line is no transaction command, otherwise false if commit failed to apply the batch.
+    auto transaction_command = [&](std::string_view line, bool count_line) -> std::optional<bool> {
+        if (line != "begin" && line != "commit" && line != "abort") return std::nullopt;
+
+        std::unique_lock<std::mutex> lock(m);
+        if (count_line) ++metrics.lines_read;
+
+        if (line == "begin") {
+            if (transaction.active) {
+                std::cerr << "begin ignored: a transaction is already active";
+                end_line(std::cerr);
+                return true;
+            }
+
+            transaction.active = true;
+            transaction.failed = false;
+            transaction.text.clear();
+            transaction.lines.clear();
+            transaction.entries.clear();
+            return true;
+        }
+
+        if (!transaction.active) {
+            std::cerr << line << " ignored: no active transaction";
+            end_line(std::cerr);
+            return true;
+        }
+        transaction.active = false;
+
+        if (line == "abort") {
+            if (VERBOSE) {
+                std::cerr << "transaction aborted (" << transaction.entries.size() << " lines)";
+                end_line(std::cerr);
+            }
+            return true;
+        }
+
+        // commit: all lines are checked before the first register is written
+        if (transaction.failed) {
+            std::cerr << "transaction discarded: invalid input line";
+            end_line(std::cerr);
+            return true;
+        }
+        for (std::size_t i = 0; i < transaction.entries.size(); ++i) {
+            auto &entry = transaction.entries[i];
+            entry.line  = std::string_view(transaction.text).substr(transaction.lines[i].first,
+                                                                   transaction.lines[i].second);
+            if (!entry_in_range(entry)) {
+                ++metrics.discarded_out_of_range;
+                std::cerr << "transaction discarded: line '" << entry.line << "': address out of range";
+                end_line(std::cerr);
+                return true;
+            }
+        }
+        lock.unlock();
+
+        // the lines before the transaction are applied separately
+        if (!apply_batch()) return false;
+
+        batch.swap(transaction.entries);
+        hold_transaction   = true;
+        const bool success = apply_batch();
+        hold_transaction   = false;
+        batch.swap(transaction.entries);
+        transaction.entries.clear();
+        return success;
+    };
+
+    // signal generators (input command 'gen'). The generators are only accessed while m is locked.
+    std::vector<std::unique_ptr<Generator>> generators;
+    std::condition_variable                 generator_cv;  // generator added or all generators finished
+    std::thread                             generator_thread;
+
+    // write the instructions of a generator sample to the shared memory (m has to be locked, semaphore acquired)
+    // (output: see report_register)
+    auto apply_sample_impl = [&](auto                             output,
+                                 const Generator                 &generator,
+                                 const InputParser::Instructions &instructions) {
+        std::array<uint16_t, InputParser::Instructions::CAPACITY> run_values {};
+        if (const auto run = register_run(instructions, run_values)) {
+            const auto &first = instructions[0];
+            apply_run(output, generator.get_definition(), first.register_type, first.address, run_values.data(), run);
+            return;
+        }
+
+        for (const auto &instruction : instructions) {
+            if (instruction.address >= register_count(instruction.register_type)) {
+                discard_out_of_range(generator.get_definition());
+                continue;
+            }
+            if (skip_write(instruction.register_type, instruction.address, instruction.value)) continue;
+            write_register(instruction.register_type, instruction.address, instruction.value);
+            report_register(output, instruction.register_type, instruction.address, instruction.value);
+        }
+    };
+
+    // one instantiation is selected by the output options
+    auto apply_sample = [&](const Generator &generator, const InputParser::Instructions &instructions) {
+        if (OUTPUT) apply_sample_impl(std::true_type(), generator, instructions);
+        else
+            apply_sample_impl(std::false_type(), generator, instructions);
+    };
+
+    // generator thread: writes the due samples of all generators with a single semaphore acquisition and sleeps
+    // (clock_nanosleep) until the next sample is due
+    auto generator_thread_func = [&] {
+        InputParser::Instructions    instructions;
+        std::unique_lock<std::mutex> lock(m);
+        while (!terminate) {
+            if (generators.empty()) {
+                generator_cv.wait(lock, [&] { return terminate || !generators.empty(); });
+                continue;
+            }
+
+            auto next = std::chrono::steady_clock::now() + GENERATOR_MAX_SLEEP;
+            for (const auto &generator : generators)
+                next = std::min(next, generator->next_time());
+            lock.unlock();
+            Replay::sleep_until(next);
+            lock.lock();
+
+            const auto now      = std::chrono::steady_clock::now();
+            bool       acquired = false;
+            bool       failed   = false;
+            for (auto &generator : generators) {
+                if (!generator->sample(now, instructions)) continue;
+
+                if (!acquired) {
+                    if (!acquire_client(lock)) {
+                        failed = true;
+                        break;
+                    }
+                    acquired = true;
+                    if (PASSTHROUGH && PASSTHROUGH_TS) write_timestamp();
+                }
+                apply_sample(*generator, instructions);
+            }
+            if (acquired) {
+                release_semaphore();
+                report_first_write();
+            }
+
+            if (failed && !terminate) {
+                std::cerr << "ERROR: generators stopped: failed to acquire the semaphore";
+                end_line(std::cerr);
+                generators.clear();
+            }
+
+            if (std::erase_if(generators, [](const auto &generator) { return generator->finished(); }) &&
+                generators.empty())
+                generator_cv.notify_all();
+
+            // the output is written after each tick (m is locked, see flush_output)
+            if (acquired) {
+                std::cout << std::flush;
+                std::cerr << std::flush;
+            }
+        }
+    };
+
+    // the end of the input does not stop the generators: wait until they are finished or the application is terminated
+    auto wait_generators = [&]() {
+        std::unique_lock<std::mutex> lock(m);
+        generator_cv.wait(lock, [&] { return terminate || generators.empty(); });
+    };
+
+    // input command 'gen': start, stop or list signal generators. The current batch is applied before.
+    // Returns std::nullopt if the line is no generator command, false if the batch could not be applied.
+    auto generator_command = [&](std::string_view line, bool count_line) -> std::optional<bool> {
+        static constexpr std::string_view COMMAND = "gen";
+        if (!line.starts_with(COMMAND) || (line.size() > COMMAND.size() && line[COMMAND.size()] != ' '))
+            return std::nullopt;
+
+        if (!apply_batch()) return false;
+
+        auto arguments = line.substr(COMMAND.size());
+        while (arguments.starts_with(' '))
+            arguments.remove_prefix(1);
+
+        std::unique_lock<std::mutex> lock(m);
+        if (count_line) ++metrics.lines_read;
+
+        if (arguments == "list") {
+            for (const auto &generator : generators) {
+                std::cerr << generator->get_definition() << ": " << generator->get_samples() << " samples ("
+                          << generator->get_skipped() << " skipped)";
+                end_line(std::cerr);
+            }
+            return true;
+        }
+
+        // gen stop [REGISTER_TYPE:ADDRESS]
+        if (arguments == "stop" || arguments.starts_with("stop ")) {
+            auto target = arguments.substr(std::string_view("stop").size());
+            while (target.starts_with(' '))
+                target.remove_prefix(1);
+
+            if (target.empty()) {
+                generators.clear();
+            } else {
+                try {
+                    const auto tpl = InputParser::compile_template(std::string(target) + ":$1", addr_base);
+                    std::erase_if(generators, [&](const auto &generator) {
+                        return generator->get_register_type() == tpl.register_type &&
+                               generator->get_address() == tpl.address;
+                    });
+                } catch (const std::exception &e) {
+                    count_parse_error(e);
+                    std::cerr << "line '" << line << "' discarded: " << e.what();
+                    end_line(std::cerr);
+                    return true;
+                }
+            }
+            generator_cv.notify_all();
+            return true;
+        }
+
+        std::unique_ptr<Generator> generator;
+        try {
+            generator = std::make_unique<Generator>(arguments, addr_base);
+        } catch (const std::exception &e) {
+            count_parse_error(e);
+            std::cerr << "line '" << line << "' discarded: " << e.what();
+            end_line(std::cerr);
+            return true;
+        }
+
+        const auto elements = register_count(generator->get_register_type());
+        if (generator->get_address() >= elements || generator->get_registers() > elements - generator->get_address()) {
+            discard_out_of_range(line);
+            return true;
+        }
+        ++metrics.lines_parsed;
+
+        // a generator replaces the generator of the same register
+        std::erase_if(generators, [&](const auto &g) {
+            return g->get_register_type() == generator->get_register_type() &&
+                   g->get_address() == generator->get_address();
+        });
+        generators.push_back(std::move(generator));
+
+        if (!generator_thread.joinable()) generator_thread = std::thread(generator_thread_func);
+        generator_cv.notify_all();
+        return true;
+    };
+
+    // process an input line: transaction command, generator command or instruction (see parse_line)
+    // Returns false if a transaction could not be applied.
+    auto process_line = [&](std::string_view line) -> bool {
+        if (const auto result = transaction_command(line, true)) return *result;
+        if (const auto result = generator_command(line, true)) return *result;
+        parse_line(line);
+        return true;
+    };
+
+    // write all complete binary records of the given buffer to the shared memory (single semaphore acquisition)
+    // returns the number of processed bytes or throws std::invalid_argument if the input is not valid
+    // (output: see report_register)
+    auto apply_records_impl = [&](auto output, const char *data, std::size_t size) -> std::size_t {
+        std::unique_lock<std::mutex> lock(m);
+
+        if (!acquire_client(lock)) throw std::runtime_error("failed to acquire semaphore");
+
+        if (PASSTHROUGH && PASSTHROUGH_TS) write_timestamp();
+
+        std::size_t pos = 0;
+        try {
+            while (size - pos >= BinaryInput::HEADER_SIZE) {
+                if (!check_hold_budget(lock)) throw std::runtime_error("failed to acquire semaphore");
+
+                const auto header      = BinaryInput::read_header(data + pos);
+                const auto record_size = BinaryInput::HEADER_SIZE + BinaryInput::payload_size(header);
+                if (size - pos < record_size) break;
+
+                const char *payload = data + pos + BinaryInput::HEADER_SIZE;
+                pos += record_size;
+
+                const auto        type  = static_cast<InputParser::Instruction::register_type_t>(header.register_type);
+                const std::size_t start = header.address;
+                const std::size_t count = header.count;
+
+                const auto elements = register_count(type);
+                if (start >= elements || count > elements - start) {
+                    std::cerr << "record (" << std::dec << count << " registers @" << start
+                              << ") discarded: address out of range";
+                    ++metrics.discarded_out_of_range;
+                    end_line(std::cerr);
+                    continue;
+                }
+
+                if (shadow) {
+                    // only the changed registers are written
+                    seqlock_begin(type);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        uint16_t value {};
+                        std::memcpy(&value, payload + i * sizeof(uint16_t), sizeof(uint16_t));
+                        if (type == InputParser::Instruction::register_type_t::DO ||
+                            type == InputParser::Instruction::register_type_t::DI)
+                            value = value ? 1 : 0;
+                        if (skip_write(type, start + i, value)) continue;
+                        write_register(type, start + i, value);
+                        report_register(output, type, start + i, value);
+                    }
+                    seqlock_end(type);
+                    continue;
+                }
+
+                switch (type) {
+                    case InputParser::Instruction::register_type_t::DO:
+                    case InputParser::Instruction::register_type_t::DI: {
+                        auto &shm = type == InputParser::Instruction::register_type_t::DO ? shm_do : shm_di;
+                        auto *dst = shm->get_addr<uint8_t *>() + start;
+                        for (std::size_t i = 0; i < count; ++i) {
+                            uint16_t value {};
+                            std::memcpy(&value, payload + i * sizeof(uint16_t), sizeof(uint16_t));
+                            dst[i] = value ? 1 : 0;
+                        }
+                        break;
+                    }
+                    case InputParser::Instruction::register_type_t::AO:
+                    case InputParser::Instruction::register_type_t::AI: {
+                        auto &shm = type == InputParser::Instruction::register_type_t::AO ? shm_ao : shm_ai;
+                        seqlock_begin(type);
+                        std::memcpy(shm->get_addr<uint16_t *>() + start, payload, count * sizeof(uint16_t));
+                        seqlock_end(type);
+                        break;
+                    }
+                }
+
+                metrics.registers_written[static_cast<std::size_t>(type)] += count;
+                if constexpr (decltype(output)::value) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        uint16_t value {};
+                        std::memcpy(&value, payload + i * sizeof(uint16_t), sizeof(uint16_t));
+                        if (type == InputParser::Instruction::register_type_t::DO ||
+                            type == InputParser::Instruction::register_type_t::DI)
+                            value = value ? 1 : 0;
+                        print_write(type, start + i, value);
+                    }
+                }
+            }
+        } catch (const std::invalid_argument &) {
+            release_semaphore();
+            throw;
+        }
+
+        release_semaphore();
+        ++stat_acquires;
+        if (pos) report_first_write();
+        return pos;
+    };
+
+    // one instantiation is selected by the output options
+    auto apply_records = [&](const char *data, std::size_t size) -> std::size_t {
+        if (OUTPUT) return apply_records_impl(std::true_type(), data, size);
+        return apply_records_impl(std::false_type(), data, size);
+    };
+
+    // read binary records from stdin
+    auto binary_input_thread_func = [&] {
+        pin_writer_thread();
+
+        std::vector<char> buffer(BINARY_BUFFER_SIZE);
+        std::size_t       fill = 0;
+
+        while (!terminate) {
+            flush_output();  // the read call might block
+            const auto n = read(STDIN_FILENO, buffer.data() + fill, buffer.size() - fill);
+            if (n == 0) break;  // eof
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("failed to read from stdin");
+                terminate = true;
+                return EX_IOERR;
+            }
+            fill += static_cast<std::size_t>(n);
+
+            std::size_t processed = 0;
+            try {
+                processed = apply_records(buffer.data(), fill);
+            } catch (const std::invalid_argument &e) {
+                std::lock_guard<std::mutex> guard(m);
+                std::cerr << "ERROR: invalid binary input: " << e.what() << std::endl;  // NOLINT
+                terminate = true;
+                return EX_DATAERR;
+            } catch (const std::runtime_error &) {
+                terminate = true;
+                return EX_SOFTWARE;
+            }
+
+            // keep incomplete record
+            std::memmove(buffer.data(), buffer.data() + processed, fill - processed);
+            fill -= processed;
+        }
+
+        std::lock_guard<std::mutex> guard(m);
+        if (fill) std::cerr << "WARNING: incomplete record at end of input discarded" << '\n';
+        std::cout << std::flush;
+        std::cerr << std::flush;
+
+        terminate = true;
+        return EX_OK;
+    };
+
+    // replay recorded scenario file. The instructions between two timing lines are applied at the recorded time.
+    auto replay_thread_func = [&] {
+        pin_writer_thread();
+
+        const auto data         = replay_file->data();
+        const auto replay_start = std::chrono::steady_clock::now();
+
+        std::optional<int64_t> first_timestamp;
+        int64_t                position_us = 0;  // position in the recording (relative to the first timestamp)
+
+        // apply pending instructions and wait until the current position of the recording is reached
+        auto wait_for_position = [&]() -> bool {
+            if (!apply_batch()) return false;
+            flush_output();
+
+            const std::chrono::duration<double, std::micro> offset(static_cast<double>(position_us) / REPLAY_SPEED);
+            Replay::sleep_until(replay_start +
+                                std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset));
+            return true;
+        };
+
+        std::size_t pos = 0;
+        while (!terminate && pos < data.size()) {
+            const auto newline = data.find('\n', pos);
+            const auto line    = data.substr(pos, newline == std::string_view::npos ? newline : newline - pos);
+            pos                = newline == std::string_view::npos ? data.size() : newline + 1;
+
+            if (line.empty()) continue;
+
+            int64_t time_us {};
+            if (Replay::parse_timestamp(line, time_us)) {
+                if (!first_timestamp) first_timestamp = time_us;
+                position_us = time_us - *first_timestamp;
+                if (!wait_for_position()) {
+                    terminate = true;
+                    return EX_SOFTWARE;
+                }
+                continue;
+            }
+
+            if (Replay::parse_sleep(line, time_us)) {
+                position_us += time_us;
+                if (!wait_for_position()) {
+                    terminate = true;
+                    return EX_SOFTWARE;
+                }
+                continue;
+            }
+
+            if (!process_line(Replay::strip_echo(line)) || (batch.size() >= BATCH_SIZE && !apply_batch())) {
+                terminate = true;
+                return EX_SOFTWARE;
+            }
+        }
+
+        if (!apply_batch()) {
+            terminate = true;
+            return EX_SOFTWARE;
+        }
+
+        wait_generators();
+        flush_output();
+        terminate = true;
+        return EX_OK;
+    };
+
+    // interactive front end: reads the lines (readline) and executes the help commands. The lines are applied by the
+    // input thread. Input and command history never block the input thread.
+    SpscQueue<std::optional<std::string>, INTERACTIVE_QUEUE_SIZE> interactive_lines;  // nullopt: end of input
+    std::atomic<bool>                                              frontend_finished = false;
+
+    auto frontend_thread_func = [&] {
+        while (!terminate) {
+            history->sync();
+
+            std::string line;
+            try {
+                line = readline->get_line(">>> ");
+            } catch (const std::runtime_error &) {
+                // eof
+                break;
+            }
+
+            if (line == "exit") break;
+
+            if (line == "help") {
+                std::lock_guard<std::mutex> guard(m);
+                std::cout << "usage: help {format, constants, types}" << '\n';
+                std::cout << '\n';
+                std::cout << "    Type 'exit' to exit the application." << '\n';
+                std::cout << "    Lines between 'begin' and 'commit' are applied together ('abort' discards them)."
+                          << '\n';
+                std::cout << "    'gen REG_TYPE:ADDRESS[:DATA_TYPE] WAVEFORM [NAME=VALUE ...]' starts a signal "
+                             "generator, 'gen list' and 'gen stop [REG_TYPE:ADDRESS]' list and stop them."
+                          << std::endl;  // NOLINT
+                continue;
+            }
+
+            if (line == "help format" || line == "help constants" || line == "help types") {
+                {
+                    std::lock_guard<std::mutex> guard(m);
+                    if (line == "help format") print_format(false);
+                    else if (line == "help constants")
+                        print_constants();
+                    else
+                        print_data_types();
+                    std::cout << std::flush;
+                }
+                history->add(std::move(line));
+                continue;
+            }
+
+            if (!line.empty() && !VALID_HIST) history->add(line);
+            interactive_lines.push(std::move(line));
+        }
+
+        interactive_lines.push(std::nullopt);
+        frontend_finished = true;
+    };
+
+    auto input_thread_func = [&] {
+        pin_writer_thread();
+
+        // the current interactive line: the batch refers to it until the batch is applied
+        std::optional<std::string> interactive_line;
+        while (!terminate) {
+            if (INTERACTIVE) {
+                interactive_line = interactive_lines.pop();
+                if (!interactive_line) break;
+
+                if (!process_line(*interactive_line)) {
+                    terminate = true;
+                    return EX_SOFTWARE;
+                }
+            } else {
+                std::string_view line_view;
+                try {
+                    if (!next_line(line_view)) break;
+                    if (!process_line(line_view)) {
+                        terminate = true;
+                        return EX_SOFTWARE;
+                    }
+
+                    // collect further lines until the batch is full or no more input arrives within the batch window
+                    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(BATCH_WINDOW_US);
+                    std::size_t lines_read = 1;
+                    while (lines_read < BATCH_SIZE && !terminate) {
+                        if (!line_reader.get_line(line_view)) {
+                            // the lines of the batch have to be applied before the buffer is reorganized
+                            if (line_reader.is_eof() || line_reader.fill_invalidates_lines() ||
+                                !line_reader.wait(deadline))
+                                break;
+                            line_reader.fill();
+                            continue;
+                        }
+
+                        if (!process_line(line_view)) {
+                            terminate = true;
+                            return EX_SOFTWARE;
+                        }
+                        ++lines_read;
+                    }
+                } catch (const std::system_error &e) {
+                    std::lock_guard<std::mutex> guard(m);
+                    std::cerr << e.what() << std::endl;  // NOLINT
+                    terminate = true;
+                    return EX_IOERR;
+                }
+            }
+
+            if (!apply_batch()) {
+                terminate = true;
+                return EX_SOFTWARE;
+            }
+        }
+
+        if (!apply_batch()) {
+            terminate = true;
+            return EX_SOFTWARE;
+        }
+
+        wait_generators();
+        flush_output();
+        terminate = true;
+        return EX_OK;
+    };
+
+    //* parsed input line (parse pipeline)
+    struct parsed_line_t {
+        std::string_view          line;
+        InputParser::Instructions instructions;
+        std::string               error;  // not empty if the line is invalid
+        bool                      unknown_type = false;  // error is an unknown register type or data type
+        uint64_t                  parse_ns     = 0;      // parse time (only if metrics are enabled)
+    };
+
+    //* chunk of input lines that is parsed by one parser thread (parse pipeline)
+    struct chunk_t {
+        std::string                           text;  // copy of the input lines (the line reader buffer is reused)
+        std::vector<parsed_line_t>            lines;
+        std::chrono::steady_clock::time_point time;          // time the lines were read (only if metrics are enabled)
+        bool                                  last = false;  // end of input marker
+    };
+
+    using chunk_queue_t = SpscQueue<std::unique_ptr<chunk_t>, PIPELINE_QUEUE_SIZE>;
+
+    // parse all lines of a chunk (parser threads, no output)
+    auto parse_chunk = [&](chunk_t &chunk) {
+        const std::string_view text = chunk.text;
+        std::size_t            pos  = 0;
+        while (pos < text.size()) {
+            const auto newline = text.find('\n', pos);
+            auto      &parsed  = chunk.lines.emplace_back();
+            parsed.line        = text.substr(pos, newline - pos);
+            pos                = newline + 1;
+
+            const auto start = METRICS ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+            try {
+                std::size_t target = 0;  // always 0: '--target' is not available in combination with the pipeline
+                if (!parse_template(parsed.line, parsed.instructions, target, false))
+                    InputParser::parse(parsed.line, parsed.instructions, addr_base, value_base);
+            } catch (std::exception &e) {
+                parsed.error        = e.what();
+                parsed.unknown_type = dynamic_cast<const InputParser::unknown_type_error *>(&e) != nullptr;
+            }
+            if (METRICS) parsed.parse_ns = elapsed_ns(start);
+        }
+    };
+
+    // write all lines of a chunk to the shared memory (writer thread)
+    auto apply_chunk = [&](chunk_t &chunk) -> bool {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            metrics.lines_read += chunk.lines.size();
+            for (const auto &parsed : chunk.lines) {
+                if (!parsed.error.empty()) continue;
+                ++metrics.lines_parsed;
+                if (METRICS) metrics.parse_time_ns.add(parsed.parse_ns);
+            }
+        }
+
+        for (auto &parsed : chunk.lines) {
+            if (const auto result = transaction_command(parsed.line, false)) {
+                if (!*result) return false;
+                continue;
+            }
+            if (const auto result = generator_command(parsed.line, false)) {
+                if (!*result) return false;
+                continue;
+            }
+
+            if (!parsed.error.empty()) {
+                std::lock_guard<std::mutex> guard(m);
+                if (parsed.unknown_type) ++metrics.discarded_unknown_type;
+                else
+                    ++metrics.discarded_parse_error;
+                if (transaction.active) transaction.failed = true;
+                std::cerr << "line '" << parsed.line << "' discarded: " << parsed.error;
+                end_line(std::cerr);
+                continue;
+            }
+
+            stage_entry({parsed.line, std::move(parsed.instructions), chunk.time});
+            if (batch.size() >= BATCH_SIZE && !apply_batch()) return false;
+        }
+
+        return apply_batch();
+    };
+
+    // parse pipeline: this thread reads the input, the parser threads parse chunks of lines and a single writer thread
+    // writes them to the shared memory.
+    // The chunks are distributed round-robin over one queue pair per parser thread. Therefore, the writer can retain
+    // the input order without reordering.
+    auto pipeline_thread_func = [&] {
+        const std::size_t chunk_lines = std::max(BATCH_SIZE, PIPELINE_CHUNK_LINES);
+
+        std::vector<std::unique_ptr<chunk_queue_t>> parse_queues;
+        std::vector<std::unique_ptr<chunk_queue_t>> write_queues;
+        for (std::size_t i = 0; i < PARSE_THREADS; ++i) {
+            parse_queues.emplace_back(std::make_unique<chunk_queue_t>());
+            write_queues.emplace_back(std::make_unique<chunk_queue_t>());
+        }
+
+        std::vector<std::thread> parsers;
+        for (std::size_t i = 0; i < PARSE_THREADS; ++i) {
+            parsers.emplace_back([&, i] {
+                while (true) {
+                    auto       chunk = parse_queues[i]->pop();
+                    const bool last  = chunk->last;
+                    if (!last) parse_chunk(*chunk);
+                    write_queues[i]->push(std::move(chunk));
+                    if (last) break;
+                }
+            });
+        }
+
+        std::thread writer([&] {
+            pin_writer_thread();
+
+            for (std::size_t seq = 0;; ++seq) {
+                auto                    &queue = *write_queues[seq % PARSE_THREADS];
+                std::unique_ptr<chunk_t> chunk;
+                if (!queue.try_pop(chunk)) {
+                    flush_output();  // pop might block
+                    chunk = queue.pop();
+                }
+
+                if (chunk->last) break;
+                if (!apply_chunk(*chunk)) {
+                    terminate = true;
+                    wake_main_loop();  // the reader might be blocked
+                    break;
+                }
+            }
+        });
+
+        int         result = EX_OK;
+        std::size_t seq    = 0;
+        try {
+            std::string_view line;
+            while (!terminate && next_line(line)) {
+                auto chunk = std::make_unique<chunk_t>();
+                if (METRICS) chunk->time = std::chrono::steady_clock::now();
+                std::size_t lines = 0;
+                do {
+                    chunk->text.append(line);
+                    chunk->text.push_back('\n');
+                } while (++lines < chunk_lines && line_reader.get_line(line));
+
+                parse_queues[seq++ % PARSE_THREADS]->push(std::move(chunk));
+            }
+        } catch (const std::system_error &e) {
+            std::lock_guard<std::mutex> guard(m);
+            std::cerr << e.what() << std::endl;  // NOLINT
+            result = EX_IOERR;
+        }
+
+        // one end of input marker per parser thread (the first one terminates the writer)
+        for (std::size_t i = 0; i < PARSE_THREADS; ++i) {
+            auto chunk  = std::make_unique<chunk_t>();
+            chunk->last = true;
+            parse_queues[(seq + i) % PARSE_THREADS]->push(std::move(chunk));
+        }
+
+        for (auto &parser : parsers)
+            parser.join();
+        writer.join();
+
+        if (result == EX_OK) wait_generators();
+        flush_output();
+        terminate = true;
+        return result;
+    };
+
+    // buffered output (restored at the end of main)
+    OutputBuffer stdout_buffer(STDOUT_FILENO);
+    OutputBuffer stderr_buffer(STDERR_FILENO);
+    auto        *cout_rdbuf = std::cout.rdbuf();
+    auto        *cerr_rdbuf = std::cerr.rdbuf();
+    if (!LINE_BUFFERED) {
+        std::cout << std::flush;
+        std::cerr << std::flush;
+        fflush(stdout);
+        std::cout.rdbuf(&stdout_buffer);
+        std::cerr.rdbuf(&stderr_buffer);
+        std::cerr.unsetf(std::ios::unitbuf);
+        std::cerr.tie(nullptr);
+    }
+
+    // write changed registers to stdout (--monitor). The shared memory is compared to a snapshot periodically.
+    auto monitor_thread_func = [&] {
+        pin_writer_thread();
+
+        //* changed register
+        struct change_t {
+            InputParser::Instruction::register_type_t type;
+            std::size_t                               address;
+            uint16_t                                  value;
+        };
+        std::vector<change_t> changes;
+
+        // shared memory of a register type (the objects are replaced by --reattach, nullptr: not opened)
+        auto mapping = [&](std::size_t index) -> const cxxshm::SharedMemory * {
+            switch (index) {
+                case 0: return shm_do.get();
+                case 1: return shm_di.get();
+                case 2: return shm_ao.get();
+                default: return shm_ai.get();
+            }
+        };
+
+        std::array<std::unique_ptr<ShmSnapshot>, 4> snapshots;  // index: register type
+
+        const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(POLL_INTERVAL_MS));
+        auto next_poll = std::chrono::steady_clock::now();
+        while (!terminate) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                if (!acquire_client(lock)) break;
+
+                for (std::size_t i = 0; i < snapshots.size(); ++i) {
+                    const auto *shm = mapping(i);
+                    if (!shm) continue;
+                    const auto type = static_cast<InputParser::Instruction::register_type_t>(i);
+
+                    // the content at startup is the reference
+                    if (!snapshots[i]) {
+                        snapshots[i] = std::make_unique<ShmSnapshot>(
+                                shm->get_addr<const void *>(), shm->get_size(), i < 2 ? 1 : sizeof(uint16_t));
+                        continue;
+                    }
+
+                    auto &snapshot = *snapshots[i];
+                    snapshot.update(shm->get_addr<const void *>(), [&](std::size_t address) {
+                        changes.push_back({type, address, snapshot.value(address)});
+                    });
+                }
+
+                release_semaphore();
+
+                // output after the semaphore is released
+                if (!changes.empty()) {
+                    if (PASSTHROUGH_TS) write_timestamp();
+                    for (const auto &change : changes) {
+                        std::cout << Metrics::REGISTER_TYPE_NAMES[static_cast<std::size_t>(change.type)] << ':'
+                                  << change.address << ':' << change.value;
+                        if (change.type == InputParser::Instruction::register_type_t::AO ||
+                            change.type == InputParser::Instruction::register_type_t::AI)
+                            std::cout << ':' << REGISTER_ENDIAN;
+                        end_line(std::cout);
+                    }
+                    std::cout << std::flush;
+                    changes.clear();
+                }
+            }
+
+            next_poll += interval;
+            const auto now = std::chrono::steady_clock::now();
+            if (next_poll < now) next_poll = now;  // overrun: no burst of polls
+            std::this_thread::sleep_until(next_poll);
+        }
+
+        flush_output();
+        terminate = true;
+        return EX_OK;
+    };
+
+    // start input thread (notifies the main event loop when it is finished).
+    std::atomic<bool> input_finished = false;
+
+    auto start_input_thread = [&](auto &thread_func) {
+        return std::thread([&] {
+            thread_func();
+            input_finished = true;
+            wake_main_loop();
+        });
+    };
+
+    startup_input = std::chrono::steady_clock::now();
+    std::thread input_thread;
+    if (MONITOR) input_thread = start_input_thread(monitor_thread_func);
+    else if (PARSE_THREADS)
+        input_thread = start_input_thread(pipeline_thread_func);
+    else if (REPLAY)
+        input_thread = start_input_thread(replay_thread_func);
+    else if (BINARY_INPUT)
+        input_thread = start_input_thread(binary_input_thread_func);
+    else
+        input_thread = start_input_thread(input_thread_func);
+
+    std::thread frontend_thread;
+    if (INTERACTIVE) frontend_thread = std::thread(frontend_thread_func);
+
+    // main event loop: termination signals, termination of the Modbus client and end of the input thread
+    // (no periodic wakeups, unless pidfd_open is not supported by the kernel)
+    const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("Failed to create epoll instance");
+        terminate = true;
+    }
+
+    auto epoll_add = [epoll_fd](int fd) {
+        epoll_event event {};
+        event.events  = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event)) perror("Failed to add file descriptor to epoll instance");
+    };
+
+    epoll_add(signal_fd);
+    epoll_add(wakeup_fd);
+    if (shm_watch) epoll_add(shm_watch->get_fd());
+    if (metrics_timer >= 0) epoll_add(metrics_timer);
+    if (metrics_socket >= 0) epoll_add(metrics_socket);
+
+    // write the metrics to stderr (--metrics-json) and to the shared memory (--metrics-shm)
+    auto publish_metrics = [&]() {
+        std::lock_guard<std::mutex> guard(m);
+        if (metrics_shm_data) metrics_shm_data->store(metrics);
+        if (METRICS_JSON) {
+            metrics.write_json(std::cerr);
+            std::cerr << std::endl;  // NOLINT
+        }
+    };
+
+    // connections of the metrics socket (--metrics-socket)
+    std::set<int> metrics_clients;
+
+    // answer a request of a metrics client (any request returns all metrics) and close the connection
+    auto serve_metrics = [&](int client) {
+        std::array<char, 1024> buffer {};
+        while (recv(client, buffer.data(), buffer.size(), 0) > 0) {}  // discard request
+
+        std::ostringstream body;
+        {
+            const std::lock_guard<std::mutex> guard(m);
+            metrics.write_prometheus(body, "stdin_to_modbus_shm_");
+        }
+        const auto content = body.str();
+
+        std::ostringstream response;
+        response << "HTTP/1.0 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << content.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << content;
+        const auto data = response.str();
+
+        // the response is small: a client that does not receive it immediately does not get (all of) it
+        [[maybe_unused]] const auto result = send(client, data.data(), data.size(), MSG_NOSIGNAL);
+
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, client, nullptr);
+        close(client);
+        metrics_clients.erase(client);
+    };
+
+    // stop writing to the shared memory of the terminated Modbus client (--reattach)
+    auto detach_client = [&]() {
+        client_attached = false;  // let a waiting writer give up the semaphore
+        std::lock_guard<std::mutex> guard(m);
+        std::cerr << "Modbus client terminated. Waiting for the restarted Modbus client ...\n" << std::flush;
+    };
+
+    // open the shared memory and the semaphore of the restarted Modbus client (--reattach).
+    // Does nothing if not all files were recreated or the shared memory was not yet resized.
+    auto attach_client = [&]() {
+        std::vector<ino_t> inodes;
+        for (const auto &file : client_files) {
+            inodes.push_back(ShmWatch::inode(file));
+            if (!inodes.back() || inodes.back() == client_inodes[inodes.size() - 1]) return;  // not yet recreated
+        }
+
+        std::unique_ptr<cxxshm::SharedMemory>    new_do;
+        std::unique_ptr<cxxshm::SharedMemory>    new_di;
+        std::unique_ptr<cxxshm::SharedMemory>    new_ao;
+        std::unique_ptr<cxxshm::SharedMemory>    new_ai;
+        std::unique_ptr<cxxsemaphore::Semaphore> new_semaphore;
+        try {
+            if (shm_do) new_do = std::make_unique<cxxshm::SharedMemory>(shm_do->get_name());
+            if (shm_di) new_di = std::make_unique<cxxshm::SharedMemory>(shm_di->get_name());
+            if (shm_ao) new_ao = std::make_unique<cxxshm::SharedMemory>(shm_ao->get_name());
+            if (shm_ai) new_ai = std::make_unique<cxxshm::SharedMemory>(shm_ai->get_name());
+            if (semaphore) new_semaphore = std::make_unique<cxxsemaphore::Semaphore>(semaphore->get_name());
+        } catch (const std::exception &) {
+            return;  // removed meanwhile
+        }
+
+        // the objects of the register types that are not opened (--types) have the size 0
+        if ((shm_do && !new_do->get_size()) || (shm_di && !new_di->get_size()) || (shm_ao && !new_ao->get_size()) ||
+            (shm_ai && !new_ai->get_size()))
+            return;
+
+        std::lock_guard<std::mutex> guard(m);
+
+        if (shm_size(new_do) != shm_size(shm_do) || shm_size(new_di) != shm_size(shm_di) ||
+            shm_size(new_ao) != shm_size(shm_ao) || shm_size(new_ai) != shm_size(shm_ai)) {
+            std::cerr << "ERROR: The shared memory of the restarted Modbus client has a different size.\n"
+                      << std::flush;
+            terminate = true;
+            return;
+        }
+
+        if (REATTACH_RESTORE) {
+            if (!new_semaphore || new_semaphore->wait(SEMAPHORE_MAX_TIME)) {
+                for (const auto &[dst, src] : {std::pair(&new_do, &shm_do),
+                                               std::pair(&new_di, &shm_di),
+                                               std::pair(&new_ao, &shm_ao),
+                                               std::pair(&new_ai, &shm_ai)}) {
+                    if (*src) std::memcpy((*dst)->get_addr<void *>(), (*src)->get_addr<void *>(), (*src)->get_size());
+                }
+                if (new_semaphore) new_semaphore->post();
+            } else {
+                std::cerr << " WARNING: Failed to acquire semaphore '" << new_semaphore->get_name()
+                          << "'. The last known register content is not restored.\n";
+            }
+        }
+
+        try {
+            prepare_mappings({new_do.get(), new_di.get(), new_ao.get(), new_ai.get()});
+        } catch (const std::system_error &e) {
+            std::cerr << "WARNING: " << e.what() << '\n';
+        }
+
+        // the shared memory of the terminated Modbus client is still mapped and is unmapped here
+        shm_do                  = std::move(new_do);
+        shm_di                  = std::move(new_di);
+        shm_ao                  = std::move(new_ao);
+        shm_ai                  = std::move(new_ai);
+        semaphore               = std::move(new_semaphore);
+        client_inodes           = std::move(inodes);
+        semaphore_error_counter = 0;
+        load_shadow();
+
+        std::cerr << "Attached to the restarted Modbus client.\n" << std::flush;
+        client_attached = true;
+        client_cv.notify_all();
+    };
+
+    int  pid_fd            = -1;
+    auto client_terminated = [&]() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            std::cerr << "Modbus client (pid=" << mb_client_pid << ") no longer alive.\n" << std::flush;
+        }
+
+        if (!REATTACH) {
+            terminate = true;
+            return;
+        }
+
+        // a restarted Modbus client has a different pid (it is detected via the shared memory files)
+        if (pid_fd >= 0) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pid_fd, nullptr);
+            close(pid_fd);
+            pid_fd = -1;
+        }
+        use_mb_client_pid = false;
+
+        if (client_attached) detach_client();
+        attach_client();
+    };
+
+    if (use_mb_client_pid) {
+        pid_fd = static_cast<int>(syscall(SYS_pidfd_open, mb_client_pid, 0));
+        if (pid_fd >= 0) epoll_add(pid_fd);
+        else if (errno == ESRCH)
+            client_terminated();
     }
 
+    while (!terminate) {
+        const int   timeout = use_mb_client_pid && pid_fd < 0 ? CLIENT_POLL_INTERVAL_MS : -1;
+        epoll_event event {};
+        const int   n = epoll_wait(epoll_fd, &event, 1, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            terminate = true;
+            break;
+        }
+
+        if (n == 0) {
+            // check if modbus client is still alive (fallback without pidfd)
+            if (kill(mb_client_pid, 0) == -1) {
+                if (errno == ESRCH) client_terminated();
+                else {
+                    perror("failed to send signal to the Modbus client");
+                    terminate = true;
+                }
+            }
+        } else if (event.data.fd == pid_fd) {
+            // the pidfd is readable as soon as the Modbus client is terminated
+            client_terminated();
+        } else if (event.data.fd == signal_fd) {
+            signalfd_siginfo info {};
+            [[maybe_unused]] const auto result = read(signal_fd, &info, sizeof(info));
+            terminate                          = true;
+        } else if (shm_watch && event.data.fd == shm_watch->get_fd()) {
+            const auto events = shm_watch->read_events();
+            if (client_attached && events.removed) detach_client();
+            if (!client_attached) attach_client();
+        } else if (event.data.fd == metrics_timer) {
+            uint64_t                    expirations {};
+            [[maybe_unused]] const auto result = read(metrics_timer, &expirations, sizeof(expirations));
+            publish_metrics();
+        } else if (event.data.fd == metrics_socket) {
+            while (true) {
+                const int client = accept4(metrics_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (client < 0) break;
+                metrics_clients.insert(client);
+                epoll_add(client);
+            }
+        } else if (metrics_clients.contains(event.data.fd)) {
+            serve_metrics(event.data.fd);
+        } else if (event.data.fd == wakeup_fd) {
+            uint64_t                    count {};
+            [[maybe_unused]] const auto result = read(wakeup_fd, &count, sizeof(count));
+            if (input_finished) break;
+        }
+    }
+
+    // a writer that waits for a restarted Modbus client has to leave the condition variable before it is destroyed
+    client_cv.notify_all();
+
+    // the generator thread finishes within GENERATOR_MAX_SLEEP (or the semaphore timeout)
+    {
+        std::lock_guard<std::mutex> guard(m);
+        terminate = true;
+    }
+    generator_cv.notify_all();
+    if (generator_thread.joinable()) generator_thread.join();
+
+    // a finished input thread is joined, otherwise it is detached (e.g. blocked in a read call) and terminated at the
+    // end of the function main
+    if (input_finished) input_thread.join();
+    else
+        input_thread.detach();
+
+    // the interactive front end is detached if it is blocked in readline()
+    if (frontend_thread.joinable()) {
+        if (frontend_finished) frontend_thread.join();
+        else
+            frontend_thread.detach();
+    }
+
+    if (pid_fd >= 0) close(pid_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (metrics_timer >= 0) close(metrics_timer);
+    for (const int client : metrics_clients)
+        close(client);
+    if (metrics_socket >= 0) {
+        close(metrics_socket);
+        unlink(metrics_socket_path.c_str());
+    }
+    close(signal_fd);
+
     std::lock_guard<std::mutex> guard(m);  // wait until the thread is not within a critical section
+
+    // restore unbuffered output (the stream buffers are destroyed at the end of main)
+    std::cout << std::flush;
+    std::cerr << std::flush;
+    std::cout.rdbuf(cout_rdbuf);
+    std::cerr.rdbuf(cerr_rdbuf);
+    std::cerr.setf(std::ios::unitbuf);
+    std::cerr.tie(&std::cout);
     if (INTERACTIVE) std::cerr << "\nTerminating ..." << std::endl;  // NOLINT
+
+    if (transaction.active) std::cerr << "WARNING: transaction discarded (missing 'commit')" << '\n';
+
+    // final metrics
+    if (metrics_shm_data) metrics_shm_data->store(metrics);
+    if (METRICS_JSON) {
+        metrics.write_json(std::cerr);
+        std::cerr << std::endl;  // NOLINT
+    }
+
+    if (BATCH_MODE && stat_acquires) {
+        std::cerr << "batch statistics: " << stat_lines << " lines in " << stat_acquires
+                  << " semaphore acquisitions (" << std::fixed << std::setprecision(2)
+                  << static_cast<double>(stat_lines) / static_cast<double>(stat_acquires) << " lines per acquisition)"
+                  << std::endl;  // NOLINT
+    }
+
+    if (SEMAPHORE_STATS && semaphore) {
+        metrics.semaphore_wait_us.print(std::cerr, "semaphore wait time (us)");
+        metrics.semaphore_hold_us.print(std::cerr, "semaphore hold time (us)");
+        if (MAX_HOLD_US) std::cerr << "hold time budget exceeded " << stat_splits << " times\n";
+        std::cerr << std::flush;
+    }
+
+    if (SKIP_SAME) std::cerr << "skipped " << stat_skipped << " writes of unchanged registers" << std::endl;  // NOLINT
 }
@@ -17,17 +17,18 @@
  * @return split string as vector of strings
  */
 [[nodiscard]] static inline std::vector<std::string> split_string(
-        std::string string, const std::string &delimiter, std::size_t max_split = ~static_cast<std::size_t>(0)) {
+        const std::string &string, const std::string &delimiter, std::size_t max_split = ~static_cast<std::size_t>(0)) {
     std::vector<std::string> split_string;  // result vector
 
-    std::size_t pos = 0;
-    while (max_split && ((pos = string.find(delimiter)) != std::string::npos)) {
-        split_string.emplace_back(string.substr(0, pos));
-        string.erase(0, pos + delimiter.length());
+    std::size_t start = 0;
+    std::size_t pos   = 0;
+    while (max_split && ((pos = string.find(delimiter, start)) != std::string::npos)) {
+        split_string.emplace_back(string, start, pos - start);
+        start = pos + delimiter.length();
         max_split--;
     }
 
-    if (!string.empty()) split_string.emplace_back(string);
+    if (start < string.size()) split_string.emplace_back(string, start);
 
     return split_string;
 }
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the GPLv3 License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+
+/**
+ * @brief convert a duration to a timespec (e.g. for ppoll or clock_nanosleep)
+ * @param duration duration (non-negative)
+ * @return duration as timespec
+ */
+[[nodiscard]] static inline timespec to_timespec(const std::chrono::nanoseconds &duration) {
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+
+    timespec ts {};
+    ts.tv_sec  = seconds.count();
+    ts.tv_nsec = (duration - seconds).count();
+    return ts;
+}